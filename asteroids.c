@@ -3,14 +3,19 @@
  */
 #include "simple.h"
 //
-/* These values indicate the maximum amount of said objects that can be active at one moment in the game. Can be replaced with linked list */
-#define MAX_PHOTONS	8
-#define MAX_ASTEROIDS	16
+/* These values are the default amount of said objects that the pools are created with. The capacities can be changed from the
+ * command line, and every pool except the photons grows when it is full. The photon capacity is how many shots the ship can have out */
+#define DEFAULT_PHOTONS	8
+#define DEFAULT_ASTEROIDS	16
+#define DEFAULT_DEBRIS 25
+#define DEFAULT_DUST 		100
+#define DEFAULT_POINTS 10
+
+/* The smallest capacity a pool can be given. The title and help screens place objects in the first 3 slots of the pools */
+#define MIN_CAPACITY 3
+
 #define MAX_VERTICES	16
 #define MAX_STARS 6
-#define MAX_DEBRIS 25
-#define MAX_DUST 		100
-#define MAX_POINTS 10
 #define MAX_ASTEROID_VARIANCE 	3
 #define MIN_ASTEROID_VARIANCE   2
 
@@ -18,31 +23,54 @@
 #define ASTEROID_MEDIUM 3
 #define ASTEROID_SMALL 2
 
+/* The collision grid's margin past the screen edges is the distance a large asteroid travels past an edge before wrapping.
+ * A cell is large enough that a large asteroid's bounding circle overlaps at most 4 cells */
+#define GRID_MARGIN (ASTEROID_LARGE*MAX_ASTEROID_VARIANCE)
+#define GRID_CELL_SIZE (2*GRID_MARGIN)
+
+/* The most vertices a ship's hull can have and the pieces of a ship that an edge of the hull can belong to */
+#define MAX_HULL_VERTICES 8
+#define SHIP_PART_RIGHT 0
+#define SHIP_PART_LEFT 1
+#define SHIP_PART_BACK 2
+
 #define drawCircle() glCallList(circle)
 /* --- Type Definitions -------------------------------------------------------- */
 
+/* The precision used to store the positions and velocities of the asteroids game's objects. Build with -DASTEROIDS_FLOAT
+ * to store them as floats, which halves their size. The playfield is only around 100 units wide so floats are precise enough.
+ * checkReplay.sh checks that both builds replay a seed exactly and that the float build follows the double build */
+#ifdef ASTEROIDS_FLOAT
+typedef float Real;
+#else
+typedef double Real;
+#endif
+
 /* Coordinates for a position on a 2D plane */
 typedef struct Coords {
-	double		x, y;
+	Real		x, y;
 } Coords;
 
 /* All pertinent values used for tracking a ship */
 typedef struct Ship{
 	int LDmg, RDmg, BDmg, type, shipUpgrade;
-	double	x, y, phi, dx, dy, size, LHp, RHp, BHp, shipSpeed, shipControl;
+	Real	x, y, phi, dx, dy;
+	double	size, LHp, RHp, BHp, shipSpeed, shipControl;
 } Ship;
 
 /* Values used with a single photon shot */
 typedef struct Photon{
 	int	active;
-	double	x, y, dx, dy;
+	Real	x, y, dx, dy;
 } Photon;
 
-/* An asteroid for the game Asteroids. Contains coordinates for each of its vertices and rotational speed */
+/* An asteroid for the game Asteroids. Contains the distance of each of its vertices from its origin and rotational speed.
+ * The vertices' positions on the screen are saved in vertex once per tick so collisions and rendering do not need to recalculate them */
 typedef struct Asteroid{
 	int	active, nVertices, size;
-	double	x, y, phi, dx, dy, dphi;
-	Coords	coords[MAX_VERTICES];
+	Real	x, y, phi, dx, dy, dphi;
+	Real	radius[MAX_VERTICES];
+	Coords	vertex[MAX_VERTICES];
 } Asteroid;
 
 /* Static dots in the background of the asteroids game. Uses the occilating global value along with it's flicker to simulate shining */
@@ -51,16 +79,18 @@ typedef struct BackgroundStar{
     double x, y, flicker, flickerRate;
 } BackgroundStar;
 
-/* Dust that comes from an asteroid. Has a lifetime and a velocity */
-typedef struct Dust{
-	int active, lifetime;
-	double x, y, dx, dy;
-} Dust;
+/* Particles that move in a straight line until their lifetime runs out. Each value is kept in it's own array (structure of arrays)
+ * so the integrator runs over contiguous memory the compiler can vectorize. Live particles are packed in the range [0, live) */
+typedef struct ParticleStore{
+	int capacity, live;
+	int *lifetime;
+	Real *x, *y, *dx, *dy;
+} ParticleStore;
 
 /* Debris that comes from an asteroid being completly destroyed. Contains 2D position along with Coords for a triangle (the debris) */
 typedef struct Debris{
 	int active, lifetime, type;
-	double x, y, phi, dx, dy, dphi;
+	Real x, y, phi, dx, dy, dphi;
 	Coords coords[3];
 } Debris;
 
@@ -77,6 +107,49 @@ typedef struct Text{
 	char* msg;
 } Text;
 
+/* The inactive slots of an object pool, kept as a stack of their indices so a slot is taken or given back in constant time.
+ * Active is the amount of objects in the pool that are currently active */
+typedef struct FreeList{
+	int *slot;
+	int count, active;
+} FreeList;
+
+/* A uniform grid over the playfield used to find objects that are near each other before running the exact collision checks.
+ * Objects are inserted as entries into every cell their bounding circle overlaps, then sorted by cell with buildCollisionGrid.
+ * The stamp of each object tracks whether it was already found by the current query */
+typedef struct CollisionGrid{
+	int columns, rows, cellCapacity;
+	int entryCount, entryCapacity, objectCapacity, currentStamp;
+	double left, bottom;
+	int *cellStart, *index;
+	int *entryCell, *entryIndex;
+	int *stamp, *result;
+} CollisionGrid;
+
+/* The 2D primitives drawn this frame that have not been sent to GL yet. Every vertex has an x, y position and an r, g, b color.
+ * All the vertices are drawn with one glDrawArrays call once the batch's primitive mode changes or the batch is flushed */
+typedef struct Batch{
+	GLenum mode;
+	int count, capacity;
+	GLfloat *vertex, *color;
+} Batch;
+
+/* A vertex of a ship's hull. It's placed at the given angle from the ship's nose (or from straight up if the hull does not rotate)
+ * and it's distance from the ship's origin is sizeScale*size + rootScale*sqrt(size). Part is the piece of the ship that takes
+ * damage when the edge going from this vertex to the next one is hit */
+typedef struct HullVertex{
+	double angle, sizeScale, rootScale;
+	int part;
+} HullVertex;
+
+/* The outline of a ship type used for it's collisions with asteroids. A direct hit on a part lowers that part's health
+ * by damage and prevents it from taking another direct hit for delay ticks. A hull with no vertices uses circle checks instead.
+ * debrisCount is how many debris pieces the whole ship breaks into when it is destroyed */
+typedef struct ShipHull{
+	int nVertices, rotates, damage, delay, debrisCount;
+	HullVertex vertex[MAX_HULL_VERTICES];
+} ShipHull;
+
 /* --- Local Variables ------------------------------------------------------------------------------ */
 
 static int level, maxLevel, respawn, cooldown, currentCooldown, photonUpgrade;
@@ -93,27 +166,58 @@ Ship ship;
 /* How many ticks are left before the text dissapears. The text displays level stats after a level in asteroids */
 static int levelTextLifetime;
 
+/* The capacity of each object pool. These are set before the pools are created in initAsteroids and increase when a pool grows */
+static int photonCapacity = DEFAULT_PHOTONS;
+static int asteroidCapacity = DEFAULT_ASTEROIDS;
+static int debrisCapacity = DEFAULT_DEBRIS;
+static int pointsCapacity = DEFAULT_POINTS;
+
 /* Photon shots fired from the player's ship in the asteroids game */
-static Photon photons[MAX_PHOTONS];
+static Photon *photons;
 
 /* Large asteroids that can collide with photon shots. Bigger asteroids turn into smaller ones on hit */
-static Asteroid	asteroids[MAX_ASTEROIDS];
+static Asteroid	*asteroids;
 
 /* That background stars that dress-up the asteroids game */
 static BackgroundStar backgroundStars[MAX_STARS*MAX_STARS];
 
 /* Large pieces of asteroids that can be collected when an asteroid is fully destroyed */
-static Debris debris[MAX_DEBRIS];
+static Debris *debris;
 
-/* Single points representing space dust that come from destroying asteroids */
-static Dust dust[MAX_DUST];
+/* Single points representing space dust that come from destroying asteroids. It's capacity is set before it is created in initAsteroids */
+static ParticleStore dust = {.capacity = DEFAULT_DUST};
 
 /* Temporary integer value that appears above an area where the user obtained points/score */
-static Points points[MAX_POINTS];
+static Points *points;
+
+/* The inactive slots of the photon pool. Photons are only activated through it and must give their slot back when deactivated */
+static FreeList photonSlots;
+
+/* The amount of live objects in the asteroid, debris and points pools. These pools are kept packed with every live
+ * object in the range [0, live), so loops only visit live objects. Removing an object moves the last live object into it's slot */
+static int liveAsteroids, liveDebris, livePoints;
 
 /* Temporary text that appears on the bottom-left of the screen when getting an upgrade */
 static Text upgradeText;
 
+/* Collision grid rebuilt by each collision check for the objects it tests against */
+static CollisionGrid collisionGrid;
+
+/* The hull of each ship type. Type 0 is a triangle with each side being it's own piece, type 1 is a square
+ * that does not rotate and type 2 is protected by a circular shield, so it has no hull */
+static const ShipHull shipHulls[3] = {
+	{3, 1, 20, 50, 3, {{0, 1, 0, SHIP_PART_LEFT}, {225*M_PI/180, 0, 1, SHIP_PART_BACK}, {135*M_PI/180, 0, 1, SHIP_PART_RIGHT}}},
+	{4, 0, 20, 30, 4, {{45*M_PI/180, 0, M_SQRT2, SHIP_PART_BACK}, {135*M_PI/180, 0, M_SQRT2, SHIP_PART_BACK},
+			{225*M_PI/180, 0, M_SQRT2, SHIP_PART_BACK}, {315*M_PI/180, 0, M_SQRT2, SHIP_PART_BACK}}},
+	{0, 0, 0, 0, 25, {{0, 0, 0, 0}}}
+};
+
+/* The current ship's hull placed at the ship's position and rotation. Updated once per tick before the ship's collisions */
+static Coords shipHullVertex[MAX_HULL_VERTICES];
+
+/* The batch that the background stars, photons, asteroids, debris and dust are drawn into */
+static Batch batch;
+
 /* --- Function prototypes --------------------------------------------------- */
 
 /* Initilization functions that create new in-game objects or activate previously disabled ones */
@@ -135,6 +239,7 @@ static void firePhoton();
 static void addScore(int p, double x, double y);
 static void nextLevel();
 static void initAsteroid(Asteroid *a, int size);
+static void updateAsteroidVertices(Asteroid *a);
 
 /* Drawing functions which end up adding some kind of visual element to the window */
 static void drawPoints(Points *p);
@@ -142,9 +247,10 @@ static void drawShip();
 static void drawPhoton(Photon *p);
 static void drawAsteroid(Asteroid *a);
 static void drawBackground(BackgroundStar *s);
-static void drawDust(Dust *d);
+static void drawDust();
 static void drawDebris(Debris *d);
 static void drawString(char* s);
+static void drawCharacter(char c);
 static void drawScore();
 static void drawUpgradeText();
 static void drawUpgrade();
@@ -169,11 +275,60 @@ static void updateDamage();
 static void updateHighscore();
 static void collisionAsteroidPhoton();
 static void collisionAsteroidShip();
+static void updateShipHull();
+static void hitShipPart(int part, int damage, int delay);
 static void collisionDebrisShip();
 static void lowerCooldown();
 
+/* Return an inactive object from a pool, growing the pool if every object is active */
+static void* growPool(void *pool, int *capacity, size_t size, int needed);
+static void initFreeList(FreeList *list, int capacity);
+static int acquireSlot(FreeList *list);
+static void releaseSlot(FreeList *list, int index);
+static void removeAsteroid(int index);
+static void removeDebris(int index);
+static void removePoints(int index);
+static void resetPools();
+static Photon* getInactivePhoton();
+static Asteroid* getInactiveAsteroid();
+static Debris* getInactiveDebris();
+static Points* getInactivePoints();
+static void freePools();
+
+/* Particle store functions, used by the dust */
+static void initParticleStore(ParticleStore *store);
+static void growParticleStore(ParticleStore *store, int needed);
+static int addParticle(ParticleStore *store, double x, double y, double dx, double dy, int lifetime);
+static void integrateParticles(ParticleStore *store, double drag);
+static void removeExpiredParticles(ParticleStore *store);
+static void freeParticleStore(ParticleStore *store);
+
+/* The collision grid is rebuilt before each collision check to only run the exact checks on objects that are near each other */
+static void resetCollisionGrid(CollisionGrid *grid);
+static void insertCollisionGrid(CollisionGrid *grid, int index, double x, double y, double radius);
+static void buildCollisionGrid(CollisionGrid *grid);
+static int queryCollisionGrid(CollisionGrid *grid, double x, double y, double radius);
+static int getCollisionGridCell(int cells, double position);
+static void freeCollisionGrid();
+
 /* Helper functions used to provide mathematical equations simplified into a function */
 static int lineCollision(double x1, double y1, double x2, double y2, double x3, double y3, double x4, double y4);
+static double segmentDistance(double px, double py, double x1, double y1, double x2, double y2);
+static int polygonCollision(Coords *a, int aCount, Coords *b, int bCount);
+
+/* Collect 2D primitives into the batch and draw them together. The batch must be flushed before anything is drawn without it */
+static void batchMode(GLenum mode);
+static void batchVertex(double x, double y, double r, double g, double b);
+static void batchFan(double x, double y, Coords *vertex, int count, double scale, double r, double g, double b);
+static void flushBatch();
+static void freeBatch();
+
+/* Every character of the text font is compiled into it's own display list, so a whole string is drawn with one call */
+static void buildGlyphs();
+
+/* Print a summary of the game's state, used to check that a seeded headless run replays the same way (-checksum) */
+static void printChecksum(int tick);
+static void hashValue(unsigned int *hash, double value);
 
 /* -- Display list for drawing a circle ----------------------------------------------------------------- */
 
@@ -197,6 +352,30 @@ buildCircle(double x, double y, double r)
     glEndList();
 }
 
+/* -- Display lists for drawing text --------------------------------------------------------------- */
+
+#define GLYPH_FONT GLUT_BITMAP_9_BY_15
+#define GLYPH_COUNT 128
+
+static GLuint glyphList;
+
+void
+buildGlyphs()
+{
+	/*
+	 * Compile every character of the font into the display list at glyphList + the character. Each list draws the
+	 * character's bitmap at the current raster position and moves the raster position to the next character
+	 */
+	int i;
+
+	glyphList = glGenLists(GLYPH_COUNT);
+	for(i = 0; i < GLYPH_COUNT; i++){
+		glNewList(glyphList + i, GL_COMPILE);
+		glutBitmapCharacter(GLYPH_FONT, i);
+		glEndList();
+	}
+}
+
 
 /* --- Initilization/Destroy functions ------------------------------------------------------------------ */
 
@@ -206,6 +385,18 @@ initAsteroids(Player *newPlayer)
 	/*
 	 * Initilize variables and structures that are used for the asteroids mini-game
 	 */
+	//Create the object pools using their set capacities. Every object starts inactive
+	photons = calloc(photonCapacity, sizeof(Photon));
+	asteroids = calloc(asteroidCapacity, sizeof(Asteroid));
+	debris = calloc(debrisCapacity, sizeof(Debris));
+	initParticleStore(&dust);
+	points = calloc(pointsCapacity, sizeof(Points));
+	initFreeList(&photonSlots, photonCapacity);
+	liveAsteroids = 0;
+	liveDebris = 0;
+	dust.live = 0;
+	livePoints = 0;
+
 	//Set the oscilatting value to begin at 0
 	oscillating = 0;
 
@@ -252,12 +443,11 @@ initAsteroid( Asteroid *a, int s)
      *	parameter that allows generating asteroids of different sizes; feel
      *	free to adjust the parameters according to your needs
      */
-    double	theta, r;
     int		i;
 
     /* Set the asteroid's position to the screen edges: Either left side or on top*/
     a->size = s;
-    if(rand()%2){
+    if(nextRandom(&randomStreams[STREAM_GAMEPLAY])%2){
         a->x = myRandom(0, xMax);
         a->y = -1*a->size*MAX_ASTEROID_VARIANCE;
     }else{
@@ -268,26 +458,41 @@ initAsteroid( Asteroid *a, int s)
     /* Prevent the asteroid from starting with a low velocity to allow it to come into view once created */
     a->dx = myRandom(0.2, 0.8);
     a->dy = myRandom(0.2, 0.8);
-    if(rand()%2){
+    if(nextRandom(&randomStreams[STREAM_GAMEPLAY])%2){
     	a->dx *= -1;
     }
-    if(rand()%2){
+    if(nextRandom(&randomStreams[STREAM_GAMEPLAY])%2){
        	a->dy *= -1;
     }
 
     /* Give the asteroid an amount of vertexes relative to it's size */
     a->dphi = myRandom(-0.2, 0.2);
-    a->nVertices = 3+a->size+rand()%(MAX_VERTICES-3-a->size);
+    a->nVertices = 3+a->size+nextRandom(&randomStreams[STREAM_GAMEPLAY])%(MAX_VERTICES-3-a->size);
     for (i=0; i<a->nVertices; i++){
-    	theta = 2.0*M_PI*i/a->nVertices;
     	//The randomness of the vertices' distance from the origin will be contained within two global variance variables
-    	r = a->size*myRandom(MIN_ASTEROID_VARIANCE, MAX_ASTEROID_VARIANCE);
-    	a->coords[i].x = -r*sin(theta);
-    	a->coords[i].y = r*cos(theta);
+    	a->radius[i] = a->size*myRandom(MIN_ASTEROID_VARIANCE, MAX_ASTEROID_VARIANCE);
     }
+    updateAsteroidVertices(a);
     a->active = 1;
 }
 
+void
+updateAsteroidVertices(Asteroid *a)
+{
+	/*
+	 * Save the position of each of the asteroid's vertices using it's position, rotation and the vertices' distance from it's origin.
+	 * The vertices are spread evenly around the asteroid, so a vertex's angle only depends on it's index
+	 */
+	int i;
+	double angle;
+
+	for(i = 0; i < a->nVertices; i++){
+		angle = a->phi + i*(2*M_PI)/a->nVertices;
+		a->vertex[i].x = a->x + a->radius[i]*sin(angle);
+		a->vertex[i].y = a->y + a->radius[i]*cos(angle);
+	}
+}
+
 void
 initDust(Asteroid *a, Asteroid *b)
 {
@@ -295,8 +500,8 @@ initDust(Asteroid *a, Asteroid *b)
      * Create a random amount of dust particles between two asteroids.
      * Will simulate an asteroid exploding if given the same asteroid twice
      */
-	int dustCount, i;
-    double x, y, dx, dy;
+	int dustCount;
+    double x, y, dx, dy, particleDx, particleDy;
 
     /* Get the point of origin for the dust particles to be between both asteroids */
     x = (a->x + b->x)/2;
@@ -304,20 +509,10 @@ initDust(Asteroid *a, Asteroid *b)
     dx = (a->dx + b->dx)/2.0;
     dy = (a->dy + b->dy)/2.0;
     /* The dust count is directly proportional to asteroid size and uses values relative to the asteroid's */
-    dustCount = a->size + b->size;
-    for(i = 0; i < MAX_DUST; i++){
-        if(dust[i].active != 1){
-            dust[i].x = x;
-            dust[i].y = y;
-            dust[i].dx = myRandom(-1.3, 1.3)*dx;
-            dust[i].dy = myRandom(-1.3, 1.3)*dy;
-            dust[i].active = 1;
-            dust[i].lifetime = 100;
-            dustCount--;
-            if(dustCount <= 0){
-                i = MAX_DUST;
-            }
-        }
+    for(dustCount = a->size + b->size; dustCount > 0; dustCount--){
+        particleDx = myRandom(-1.3, 1.3)*dx;
+        particleDy = myRandom(-1.3, 1.3)*dy;
+        addParticle(&dust, x, y, particleDx, particleDy, 100);
     }
 }
 
@@ -350,9 +545,9 @@ destroyShip()
 	 * A Dmg value can't reach a negative number (it stops at 0) unless its specifically set to negative.
 	 * Therefore, we know a ship piece has been destroyed/made as debris once we set their Dmg value to negative
 	 */
-	int i, count;
+	int i;
 	Debris *piece;
-	piece = NULL;
+	const ShipHull *hull = &shipHulls[ship.type];
 
 	/* each ship type gets destroyed in it's own way */
 	if(ship.type == 0){
@@ -360,176 +555,129 @@ destroyShip()
 		if(ship.LDmg >= 0 && ship.RDmg >= 0 && ship.BDmg >= 0){
 			if(ship.LHp <= 0){
 				/* Create left-side ship debris by using the inactive debris pieces and values from the ship */
-				for(i = 0; i < MAX_DEBRIS; i++){
-					if(!(debris[i].active)){
-						piece = &debris[i];
-						i = MAX_DEBRIS;
-					}
-				}
-				if(piece != NULL){
-					piece->x = ship.x;
-					piece->y = ship.y;
-					piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
-					piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
-					piece->phi = ship.phi;
-					piece->dphi = myRandom(-0.2, 0.2);
-					piece->coords[0].x = 0.0;
-					piece->coords[0].y = 0.0;
-					piece->coords[1].x = ship.size*sin(ship.phi);
-					piece->coords[1].y = ship.size*cos(ship.phi);
-					piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (225*M_PI/180));
-					piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (225*M_PI/180));
-					piece->lifetime = 125*myRandom(0.95, 1.05);
-					piece->active = 1;
-					piece->type = 0;
-				}
+				piece = getInactiveDebris();
+				piece->x = ship.x;
+				piece->y = ship.y;
+				piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
+				piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
+				piece->phi = ship.phi;
+				piece->dphi = myRandom(-0.2, 0.2);
+				piece->coords[0].x = 0.0;
+				piece->coords[0].y = 0.0;
+				piece->coords[1].x = ship.size*sin(ship.phi);
+				piece->coords[1].y = ship.size*cos(ship.phi);
+				piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (225*M_PI/180));
+				piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (225*M_PI/180));
+				piece->lifetime = 125*myRandom(0.95, 1.05);
+				piece->active = 1;
+				piece->type = 0;
 				ship.LDmg = -1;
 			}
 
-			piece = NULL;
 			if(ship.RHp <= 0){
 				/* Create right-side ship debris by using the inactive debris pieces and values from the ship */
-				for(i = 0; i < MAX_DEBRIS; i++){
-					if(!(debris[i].active)){
-						piece = &debris[i];
-						i = MAX_DEBRIS;
-					}
-				}
-				if(piece != NULL){
-					piece->x = ship.x;
-					piece->y = ship.y;
-					piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
-					piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
-					piece->phi = ship.phi;
-					piece->dphi = myRandom(-0.2, 0.2);
-					piece->coords[0].x = 0.0;
-					piece->coords[0].y = 0.0;
-					piece->coords[1].x = ship.size*sin(ship.phi);
-					piece->coords[1].y = ship.size*cos(ship.phi);
-					piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (135*M_PI/180));
-					piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (135*M_PI/180));
-					piece->lifetime = 125*myRandom(0.95, 1.05);
-					piece->active = 1;
-					piece->type = 0;
-				}
+				piece = getInactiveDebris();
+				piece->x = ship.x;
+				piece->y = ship.y;
+				piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
+				piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
+				piece->phi = ship.phi;
+				piece->dphi = myRandom(-0.2, 0.2);
+				piece->coords[0].x = 0.0;
+				piece->coords[0].y = 0.0;
+				piece->coords[1].x = ship.size*sin(ship.phi);
+				piece->coords[1].y = ship.size*cos(ship.phi);
+				piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (135*M_PI/180));
+				piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (135*M_PI/180));
+				piece->lifetime = 125*myRandom(0.95, 1.05);
+				piece->active = 1;
+				piece->type = 0;
 				ship.RDmg = -1;
 			}
 
-			piece = NULL;
 			if(ship.BHp <= 0){
 				/* Create back-side ship debris by using the inactive debris pieces and values from the ship */
-				for(i = 0; i < MAX_DEBRIS; i++){
-					if(!(debris[i].active)){
-						piece = &debris[i];
-						i = MAX_DEBRIS;
-					}
-				}
-				if(piece != NULL){
-					piece->x = ship.x;
-					piece->y = ship.y;
-					piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
-					piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
-					piece->phi = ship.phi;
-					piece->dphi = myRandom(-0.2, 0.2);
-					piece->coords[0].x = 0.0;
-					piece->coords[0].y = 0.0;
-					piece->coords[1].x = sqrt(ship.size)*sin(ship.phi + (135*M_PI/180));
-					piece->coords[1].y = sqrt(ship.size)*cos(ship.phi + (135*M_PI/180));
-					piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (225*M_PI/180));
-					piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (225*M_PI/180));
-					piece->lifetime = 125*myRandom(0.95, 1.05);
-					piece->active = 1;
-					piece->type = 0;
-				}
+				piece = getInactiveDebris();
+				piece->x = ship.x;
+				piece->y = ship.y;
+				piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
+				piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
+				piece->phi = ship.phi;
+				piece->dphi = myRandom(-0.2, 0.2);
+				piece->coords[0].x = 0.0;
+				piece->coords[0].y = 0.0;
+				piece->coords[1].x = sqrt(ship.size)*sin(ship.phi + (135*M_PI/180));
+				piece->coords[1].y = sqrt(ship.size)*cos(ship.phi + (135*M_PI/180));
+				piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (225*M_PI/180));
+				piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (225*M_PI/180));
+				piece->lifetime = 125*myRandom(0.95, 1.05);
+				piece->active = 1;
+				piece->type = 0;
 				ship.BDmg = -1;
 			}
 		}else{
 			/* Destroy what's left of the ship pieces that are still attached if there
 			 * is already a piece gone to prevent the ship being a single piece */
-			piece = NULL;
 			if(ship.LDmg >= 0){
 				/* Create left-side ship debris by using the inactive debris pieces and values from the ship */
-				for(i = 0; i < MAX_DEBRIS; i++){
-					if(!(debris[i].active)){
-						piece = &debris[i];
-						i = MAX_DEBRIS;
-					}
-				}
-				if(piece != NULL){
-					piece->x = ship.x;
-					piece->y = ship.y;
-					piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
-					piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
-					piece->phi = ship.phi;
-					piece->dphi = myRandom(-0.2, 0.2);
-					piece->coords[0].x = 0.0;
-					piece->coords[0].y = 0.0;
-					piece->coords[1].x = ship.size*sin(ship.phi);
-					piece->coords[1].y = ship.size*cos(ship.phi);
-					piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (225*M_PI/180));
-					piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (225*M_PI/180));
-					piece->lifetime = 125*myRandom(0.95, 1.05);
-					piece->active = 1;
-					piece->type = 0;
-				}
+				piece = getInactiveDebris();
+				piece->x = ship.x;
+				piece->y = ship.y;
+				piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
+				piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
+				piece->phi = ship.phi;
+				piece->dphi = myRandom(-0.2, 0.2);
+				piece->coords[0].x = 0.0;
+				piece->coords[0].y = 0.0;
+				piece->coords[1].x = ship.size*sin(ship.phi);
+				piece->coords[1].y = ship.size*cos(ship.phi);
+				piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (225*M_PI/180));
+				piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (225*M_PI/180));
+				piece->lifetime = 125*myRandom(0.95, 1.05);
+				piece->active = 1;
+				piece->type = 0;
 				ship.LDmg = -1;
 			}
 
-			piece = NULL;
 			if(ship.RDmg >= 0){
 				/* Create right-side ship debris by using the inactive debris pieces and values from the ship */
-				for(i = 0; i < MAX_DEBRIS; i++){
-					if(!(debris[i].active)){
-						piece = &debris[i];
-						i = MAX_DEBRIS;
-					}
-				}
-				if(piece != NULL){
-					piece->x = ship.x;
-					piece->y = ship.y;
-					piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
-					piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
-					piece->phi = ship.phi;
-					piece->dphi = myRandom(-0.2, 0.2);
-					piece->coords[0].x = 0.0;
-					piece->coords[0].y = 0.0;
-					piece->coords[1].x = ship.size*sin(ship.phi);
-					piece->coords[1].y = ship.size*cos(ship.phi);
-					piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (135*M_PI/180));
-					piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (135*M_PI/180));
-					piece->lifetime = 125*myRandom(0.95, 1.05);
-					piece->active = 1;
-					piece->type = 0;
-				}
+				piece = getInactiveDebris();
+				piece->x = ship.x;
+				piece->y = ship.y;
+				piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
+				piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
+				piece->phi = ship.phi;
+				piece->dphi = myRandom(-0.2, 0.2);
+				piece->coords[0].x = 0.0;
+				piece->coords[0].y = 0.0;
+				piece->coords[1].x = ship.size*sin(ship.phi);
+				piece->coords[1].y = ship.size*cos(ship.phi);
+				piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (135*M_PI/180));
+				piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (135*M_PI/180));
+				piece->lifetime = 125*myRandom(0.95, 1.05);
+				piece->active = 1;
+				piece->type = 0;
 				ship.RDmg = -1;
 			}
 
-			piece = NULL;
 			if(ship.BDmg >= 0){
 				/* Create back-side ship debris by using the inactive debris pieces and values from the ship */
-				for(i = 0; i < MAX_DEBRIS; i++){
-					if(!(debris[i].active)){
-						piece = &debris[i];
-						i = MAX_DEBRIS;
-					}
-				}
-				if(piece != NULL){
-					piece->x = ship.x;
-					piece->y = ship.y;
-					piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
-					piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
-					piece->phi = ship.phi;
-					piece->dphi = myRandom(-0.2, 0.2);
-					piece->coords[0].x = 0.0;
-					piece->coords[0].y = 0.0;
-					piece->coords[1].x = sqrt(ship.size)*sin(ship.phi + (135*M_PI/180));
-					piece->coords[1].y = sqrt(ship.size)*cos(ship.phi + (135*M_PI/180));
-					piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (225*M_PI/180));
-					piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (225*M_PI/180));
-					piece->lifetime = 125*myRandom(0.95, 1.05);
-					piece->active = 1;
-					piece->type = 0;
-				}
+				piece = getInactiveDebris();
+				piece->x = ship.x;
+				piece->y = ship.y;
+				piece->dx = myRandom(-0.25, 0.25)*ship.dx + myRandom(-0.1, 0.1);
+				piece->dy = myRandom(-0.25, 0.25)*ship.dy + myRandom(-0.1, 0.1);
+				piece->phi = ship.phi;
+				piece->dphi = myRandom(-0.2, 0.2);
+				piece->coords[0].x = 0.0;
+				piece->coords[0].y = 0.0;
+				piece->coords[1].x = sqrt(ship.size)*sin(ship.phi + (135*M_PI/180));
+				piece->coords[1].y = sqrt(ship.size)*cos(ship.phi + (135*M_PI/180));
+				piece->coords[2].x = sqrt(ship.size)*sin(ship.phi + (225*M_PI/180));
+				piece->coords[2].y = sqrt(ship.size)*cos(ship.phi + (225*M_PI/180));
+				piece->lifetime = 125*myRandom(0.95, 1.05);
+				piece->active = 1;
+				piece->type = 0;
 			}
 			/* set the ship's health values to 0 and set the respawn
 			 * time variable to start counting down to the ship respawn */
@@ -541,42 +689,39 @@ destroyShip()
 	}
 	else if(ship.type == 1){
 		/* destroy the ship by creating 4 debris pieces floating into each direction */
-		/* get the next non-active available debris piece and track the amount of pieces created */
-		count = 0;
-		for(i = 0; i < MAX_DEBRIS; i++){
-			if(!(debris[i].active)){
-				piece = &debris[i];
-				piece->x = ship.x;
-				piece->y = ship.y;
-				/* Pieces are generated starting from the right and going clockwise */
-				piece->dx = (count == 0)*0.3 - (count == 2)*0.3 + 0.5*ship.dx + myRandom(-0.1, 0.1) ;
-				piece->dy = (count == 3)*0.3 - (count == 1)*0.3 + 0.5*ship.dy + myRandom(-0.1, 0.1);
-				piece->coords[1].x = sqrt(ship.size) - (count == 0 || count == 1)*2*sqrt(ship.size);
-				piece->coords[1].y = sqrt(ship.size) - (count == 1 || count == 2)*2*sqrt(ship.size);
-				piece->coords[2].x = sqrt(ship.size) - (count == 1 || count == 2)*2*sqrt(ship.size);
-				piece->coords[2].y = sqrt(ship.size) - (count == 2 || count == 3)*2*sqrt(ship.size);
-				piece->phi = ship.phi;
-				piece->dphi = myRandom(-0.2, 0.2);
-				piece->coords[0].x = 0.0;
-				piece->coords[0].y = 0.0;
-				piece->lifetime = 125*myRandom(0.95, 1.05);
-				piece->active = 1;
-				piece->type = 0;
-
-				count++;
-				if(count >= 4){
-					i = MAX_DEBRIS;
-				}
-			}
+		/* get the next non-active available debris piece and track the amount of pieces created. The pieces are the
+		 * square's four quarters, so there are always 4 of them */
+		for(i = 0; i < hull->debrisCount; i++){
+			piece = getInactiveDebris();
+			piece->x = ship.x;
+			piece->y = ship.y;
+			/* Pieces are generated starting from the right and going clockwise */
+			piece->dx = (i == 0)*0.3 - (i == 2)*0.3 + 0.5*ship.dx + myRandom(-0.1, 0.1) ;
+			piece->dy = (i == 3)*0.3 - (i == 1)*0.3 + 0.5*ship.dy + myRandom(-0.1, 0.1);
+			piece->coords[1].x = sqrt(ship.size) - (i == 0 || i == 1)*2*sqrt(ship.size);
+			piece->coords[1].y = sqrt(ship.size) - (i == 1 || i == 2)*2*sqrt(ship.size);
+			piece->coords[2].x = sqrt(ship.size) - (i == 1 || i == 2)*2*sqrt(ship.size);
+			piece->coords[2].y = sqrt(ship.size) - (i == 2 || i == 3)*2*sqrt(ship.size);
+			piece->phi = ship.phi;
+			piece->dphi = myRandom(-0.2, 0.2);
+			piece->coords[0].x = 0.0;
+			piece->coords[0].y = 0.0;
+			piece->lifetime = 125*myRandom(0.95, 1.05);
+			piece->active = 1;
+			piece->type = 0;
 		}
 		/* set the ship's health value to 0 and set the respawn time variable */
 		ship.BHp = 0;
 		ship.BDmg = -1;
 		respawn = 200;
 	}else if(ship.type == 2){
-		/* destroy the ship by filling the debris array with ship pieces, overriding any active debris pieces */
-		for(i = 0; i < MAX_DEBRIS; i++){
-			piece = &debris[i];
+		/* destroy the ship by filling the start of the debris pool with ship pieces, overriding any live debris pieces */
+		for(i = 0; i < hull->debrisCount; i++){
+			if(i < liveDebris){
+				piece = &debris[i];
+			}else{
+				piece = getInactiveDebris();
+			}
 			piece->dx = myRandom(-0.15, 0.15)*ship.dx + myRandom(-0.3, 0.3);
 			piece->dy = myRandom(-0.15, 0.15)*ship.dy + myRandom(-0.3, 0.3);
 			piece->x = ship.x + piece->dx*10;
@@ -616,12 +761,13 @@ destroyAsteroid(Asteroid *a, Photon *p)
 	 */
 	int space;
 	int children;
-	int theta;
-	int r;
+	int parent;
 	int i;
 	int j;
 	int debrisCount;
+	Debris *piece;
 	p->active = 0;
+	releaseSlot(&photonSlots, p - photons);
 
 	/* give the user points relative to the asteroid's current size and update the appropriate score tracking value */
 	addScore(a->size, a->x, a->y);
@@ -638,30 +784,24 @@ destroyAsteroid(Asteroid *a, Photon *p)
 		a->active = 0;
 		children = 0;
 		/* create 3 or 2 debris objects to simulate the asteroid being destroyed. each debris piece is made of three vertexes */
-		debrisCount = floor(myRandom(2.5, 3.5));
-		for(i = 0; i < MAX_DEBRIS; i++){
-			if(!(debris[i].active)){
-				debris[i].active = 1;
-				//The debris type has a 10% chance to be an upgrade
-				debris[i].type = 1 + (myRandom(0.0, 1.0) > 0.9);
-				debris[i].dx = (myRandom(0.25, 0.55)*a->dx + myRandom(-0.1, 0.1))*sin(debrisCount*2*M_PI/3);
-				debris[i].dy = (myRandom(0.25, 0.55)*a->dy + myRandom(-0.1, 0.1))*cos(debrisCount*2*M_PI/3);
-				debris[i].x = a->x + debris[i].dx*3;
-				debris[i].y = a->y + debris[i].dx*3;
-				debris[i].phi = myRandom(0.0, M_PI);
-				debris[i].dphi = myRandom(-0.2, 0.2);
-				debris[i].coords[0].x = 0.0 + myRandom(-0.5, 0.5);
-				debris[i].coords[0].y = 2.0 + myRandom(-0.5, 0.5);
-				debris[i].coords[1].x = -sqrt(2.0) + myRandom(-0.5, 0.5);
-				debris[i].coords[1].y = -sqrt(2.0) + myRandom(-0.5, 0.5);
-				debris[i].coords[2].x = sqrt(2.0) + myRandom(-0.5, 0.5);
-				debris[i].coords[2].y = -sqrt(2.0) + myRandom(-0.5, 0.5);
-				debris[i].lifetime = 125*myRandom(0.75, 1.25);
-				debrisCount--;
-			}
-			if(debrisCount <= 0){
-				i = MAX_DEBRIS;
-			}
+		for(debrisCount = floor(myRandom(2.5, 3.5)); debrisCount > 0; debrisCount--){
+			piece = getInactiveDebris();
+			piece->active = 1;
+			//The debris type has a 10% chance to be an upgrade
+			piece->type = 1 + (myRandom(0.0, 1.0) > 0.9);
+			piece->dx = (myRandom(0.25, 0.55)*a->dx + myRandom(-0.1, 0.1))*sin(debrisCount*2*M_PI/3);
+			piece->dy = (myRandom(0.25, 0.55)*a->dy + myRandom(-0.1, 0.1))*cos(debrisCount*2*M_PI/3);
+			piece->x = a->x + piece->dx*3;
+			piece->y = a->y + piece->dx*3;
+			piece->phi = myRandom(0.0, M_PI);
+			piece->dphi = myRandom(-0.2, 0.2);
+			piece->coords[0].x = 0.0 + myRandom(-0.5, 0.5);
+			piece->coords[0].y = 2.0 + myRandom(-0.5, 0.5);
+			piece->coords[1].x = -sqrt(2.0) + myRandom(-0.5, 0.5);
+			piece->coords[1].y = -sqrt(2.0) + myRandom(-0.5, 0.5);
+			piece->coords[2].x = sqrt(2.0) + myRandom(-0.5, 0.5);
+			piece->coords[2].y = -sqrt(2.0) + myRandom(-0.5, 0.5);
+			piece->lifetime = 125*myRandom(0.75, 1.25);
 		}
 
 	/* Set asteroid parameters used with child asteroid creation */
@@ -674,14 +814,11 @@ destroyAsteroid(Asteroid *a, Photon *p)
 	}
 
 	/*reconstruct the parent asteroid using it's new size */
-	a->nVertices = 3+a->size+rand()%(MAX_VERTICES-3-a->size);
+	a->nVertices = 3+a->size+nextRandom(&randomStreams[STREAM_GAMEPLAY])%(MAX_VERTICES-3-a->size);
 	for (i=0; i<a->nVertices; i++){
-		theta = 2.0*M_PI*i/a->nVertices;
-		r = a->size*myRandom(MIN_ASTEROID_VARIANCE, MAX_ASTEROID_VARIANCE);
-		a->coords[i].x = -r*sin(theta);
-		a->coords[i].y = r*cos(theta);
-
+		a->radius[i] = (int) (a->size*myRandom(MIN_ASTEROID_VARIANCE, MAX_ASTEROID_VARIANCE));
 	}
+	updateAsteroidVertices(a);
 
 	/* depending on the velocity of the photon shot and the current size of the asteroid,
 	 * change the asteroid's velocity slightly. This is to simulate an actual "collision" */
@@ -700,69 +837,52 @@ destroyAsteroid(Asteroid *a, Photon *p)
 		a->dy = -1;
 	}
 
-	/* Create a child asteroid if there's memory and the original asteroid was large enough (size is not "small") */
+	/* Create the child asteroids from inactive asteroids using their parent's values. Getting an inactive asteroid can grow
+	 * the asteroid pool and move it, so the parent is found again by it's index after each child is made */
 	Asteroid *child;
-
-	/* check the asteroids array to see how many children asteroids
-	 * will be added compared to how much space is left in the array.
-	 * Change the values to find out how many children will be made */
-	space = 0;
-	for(i = 0; i < MAX_ASTEROIDS; i++){
-		child = &asteroids[i];
-		if(!(child->active)){
-			space++;
+	parent = a - asteroids;
+	for(space = children; space > 0; space--){
+		child = getInactiveAsteroid();
+		a = &asteroids[parent];
+		child->size = a->size;
+		/* add some distance relative to the photon's direction to
+		 * the child's position so all asteroids are not overlapping */
+		if(p->dy < 0){
+			child->x = a->x - sin(atan(p->dx/p->dy) + M_PI/2 - space*M_PI/(1+children))*(child->size + a->size);
+			child->y = a->y - cos(atan(p->dx/p->dy) + M_PI/2 - space*M_PI/(1+children))*(child->size + a->size);
+		}else{
+			child->x = a->x + sin(atan(p->dx/p->dy) + M_PI/2 - space*M_PI/(1+children))*(child->size + a->size);
+			child->y = a->y + cos(atan(p->dx/p->dy) + M_PI/2 - space*M_PI/(1+children))*(child->size + a->size);
 		}
-	}
-	if(children > space){
-		children = space;
-	}else{
-		space = children;
-	}
-
-	/* Use inactive asteroids to create children asteroids using their parent's values */
-	for(i = 0; i < MAX_ASTEROIDS; i++){
-		child = &asteroids[i];
-		if(!(child->active)){
-			if(space > 0){
-				child->size = a->size;
-				/* add some distance relative to the photon's direction to
-				 * the child's position so all asteroids are not overlapping */
-				if(p->dy < 0){
-					child->x = a->x - sin(atan(p->dx/p->dy) + M_PI/2 - space*M_PI/(1+children))*(child->size + a->size);
-					child->y = a->y - cos(atan(p->dx/p->dy) + M_PI/2 - space*M_PI/(1+children))*(child->size + a->size);
-				}else{
-					child->x = a->x + sin(atan(p->dx/p->dy) + M_PI/2 - space*M_PI/(1+children))*(child->size + a->size);
-					child->y = a->y + cos(atan(p->dx/p->dy) + M_PI/2 - space*M_PI/(1+children))*(child->size + a->size);
-				}
-				/* inherent a portion of its parents rotational speed and prevent it from spinning too fast */
-				child->dphi = a->dphi*myRandom(0.5, 1.4);
-				if(child->dphi > 0.2){
-				    child->dphi = 0.2;
-				}else if(child->dphi < -0.2){
-				    child->dphi = -0.2;
-				}
-				/* Use the photon's speed, the parent's speed and position of origin to determine the child's velocity */
-				if(a->y - child->y >= 0){
-					child->dx = -sin(atan((a->x - child->x) / (a->y - child->y)))/child->size + a->dx;
-					child->dy = -cos(atan((a->x - child->x) / (a->y - child->y)))/child->size + a->dy;
-				}else{
-					child->dx = sin(atan((a->x - child->x) / (a->y - child->y)))/child->size + a->dx;
-					child->dy = cos(atan((a->x - child->x) / (a->y - child->y)))/child->size + a->dy;
-				}
-				/* Create the child's vertexes */
-				child->phi = a->phi;
-				child->nVertices = 6+rand()%(MAX_VERTICES-6);
-				initDust(child, a);
-				child->active = 1;
-				for (j=0; j<child->nVertices; j++){
-					theta = 2.0*M_PI*j/child->nVertices;
-					r = child->size*myRandom(MIN_ASTEROID_VARIANCE, MAX_ASTEROID_VARIANCE);
-					child->coords[j].x = -r*sin(theta);
-					child->coords[j].y = r*cos(theta);
-				}
-				space--;
-			}
+		/* inherent a portion of its parents rotational speed and prevent it from spinning too fast */
+		child->dphi = a->dphi*myRandom(0.5, 1.4);
+		if(child->dphi > 0.2){
+		    child->dphi = 0.2;
+		}else if(child->dphi < -0.2){
+		    child->dphi = -0.2;
+		}
+		/* Use the photon's speed, the parent's speed and position of origin to determine the child's velocity */
+		if(a->y - child->y >= 0){
+			child->dx = -sin(atan((a->x - child->x) / (a->y - child->y)))/child->size + a->dx;
+			child->dy = -cos(atan((a->x - child->x) / (a->y - child->y)))/child->size + a->dy;
+		}else{
+			child->dx = sin(atan((a->x - child->x) / (a->y - child->y)))/child->size + a->dx;
+			child->dy = cos(atan((a->x - child->x) / (a->y - child->y)))/child->size + a->dy;
 		}
+		/* Create the child's vertexes */
+		child->phi = a->phi;
+		child->nVertices = 6+nextRandom(&randomStreams[STREAM_GAMEPLAY])%(MAX_VERTICES-6);
+		initDust(child, a);
+		child->active = 1;
+		for (j=0; j<child->nVertices; j++){
+			child->radius[j] = (int) (child->size*myRandom(MIN_ASTEROID_VARIANCE, MAX_ASTEROID_VARIANCE));
+		}
+		updateAsteroidVertices(child);
+	}
+
+	/* Remove the parent once it's fully destroyed. This is done last as the final live asteroid is moved into it's slot */
+	if(!(a->active)){
+		removeAsteroid(a - asteroids);
 	}
 }
 
@@ -772,24 +892,15 @@ destroyDebris(Debris *d)
 	/*
 	 * Destroy the debris and spawn a group of space dust in it's place.
 	 */
-	int i, dustCount;
-
-	dustCount = myRandom(8, 15);
-	for(i = 0; i < MAX_DUST; i++){
-		if(dust[i].active != 1){
-			dustCount--;
-			dust[i].active = 1;
-			dust[i].dx = myRandom(-1.0, 1.0);
-			dust[i].dy = myRandom(-1.0, 1.0);
-			dust[i].x = d->x + dust[i].dx*3;
-			dust[i].y = d->y + dust[i].dy*3;
-			dust[i].lifetime = 45;
-			if(dustCount <= 0){
-				i = MAX_DUST;
-			}
-		}
+	int dustCount;
+	double dx, dy;
+
+	for(dustCount = myRandom(8, 15); dustCount > 0; dustCount--){
+		dx = myRandom(-1.0, 1.0);
+		dy = myRandom(-1.0, 1.0);
+		addParticle(&dust, d->x + dx*3, d->y + dy*3, dx, dy, 45);
 	}
-	d->active = 0;
+	removeDebris(d - debris);
 }
 
 
@@ -801,18 +912,15 @@ drawPoints(Points *p)
     /*
      * Draw a floating integer and a + symbol that represents the amount of points the user gained from an action
      */
-	int i, s;
+	char text[16];
 
 	glColor3f(1, 1, 1);
 	glRasterPos2f(p->x, p->y);
-	glutBitmapCharacter(GLUT_BITMAP_9_BY_15, '+');
-
-	i = 0;
-	for(s = p->amount; s > 0; s = s/10){
-		i++;
-	}
-	for(s = p->amount; i > 0; i--){
-		glutBitmapCharacter(GLUT_BITMAP_9_BY_15, (s/((int) pow(10,i-1)))%(10) + '0');
+	if(p->amount > 0){
+		sprintf(text, "+%d", p->amount);
+		drawString(text);
+	}else{
+		drawString("+");
 	}
 }
 
@@ -842,7 +950,6 @@ drawShip()
 			glVertex2d(ship.x + sqrt(ship.size)*sin(ship.phi + (225*M_PI/180)),
 					ship.y + sqrt(ship.size)*cos(ship.phi + (225*M_PI/180)));
 			glEnd();
-			glFlush();
 		}
 		/* draw the right triangle piece of the ship */
 		if(ship.RHp > 0){
@@ -855,7 +962,6 @@ drawShip()
 			glVertex2d(ship.x + ship.size*sin(ship.phi), ship.y + ship.size*cos(ship.phi));
 			glVertex2d(ship.x + sqrt(ship.size)*sin(ship.phi + (135*M_PI/180)), ship.y + sqrt(ship.size)*cos(ship.phi + (135*M_PI/180)));
 			glEnd();
-			glFlush();
 		}
 		/* draw the back triangle piece of the ship */
 		if(ship.BHp > 0){
@@ -867,7 +973,6 @@ drawShip()
 			glVertex2d(ship.x + sqrt(ship.size)*sin(ship.phi + (135*M_PI/180)), ship.y + sqrt(ship.size)*cos(ship.phi + (135*M_PI/180)));
 			glVertex2d(ship.x + sqrt(ship.size)*sin(ship.phi + (225*M_PI/180)), ship.y + sqrt(ship.size)*cos(ship.phi + (225*M_PI/180)));
 			glEnd();
-			glFlush();
 		}
 	}else if(ship.type == 1){
 		/* Draw a cube made of 4 triangles, starting from the top right vertex and going clockwise */
@@ -882,7 +987,6 @@ drawShip()
 			glVertex2d(ship.x - sqrt(ship.size), ship.y - sqrt(ship.size));
 			glVertex2d(ship.x + sqrt(ship.size), ship.y - sqrt(ship.size));
 			glEnd();
-			glFlush();
 		}
 	}else if(ship.type == 2){
 		if(ship.BHp > 0){
@@ -900,8 +1004,8 @@ drawShip()
 						//Have the shield retract back into the ship when it's about to start recharging
 						r = (ship.size + (i+1)) - (ship.LDmg < 30)*(1 - (ship.LDmg/30.0))*(ship.size);
 						for(k=0; k<40; k++)
-							glVertex2d(ship.x + cos(k*M_PI/20.0)*r + (ship.LHp < (i+1)*ship.RHp/3)*(1-(ship.LHp - (i*ship.RHp/3))/(ship.RHp/3))*myRandom(-0.5, 0.5) + myRandom(-0.1, 0.1)
-									, ship.y + sin(k*M_PI/20.0)*r + (ship.LHp < (i+1)*ship.RHp/3)*(1-(ship.LHp - (i*ship.RHp/3))/(ship.RHp/3))*myRandom(-0.5, 0.5) + myRandom(-0.1, 0.1));
+							glVertex2d(ship.x + cos(k*M_PI/20.0)*r + (ship.LHp < (i+1)*ship.RHp/3)*(1-(ship.LHp - (i*ship.RHp/3))/(ship.RHp/3))*effectRandom(-0.5, 0.5) + effectRandom(-0.1, 0.1)
+									, ship.y + sin(k*M_PI/20.0)*r + (ship.LHp < (i+1)*ship.RHp/3)*(1-(ship.LHp - (i*ship.RHp/3))/(ship.RHp/3))*effectRandom(-0.5, 0.5) + effectRandom(-0.1, 0.1));
 						glEnd();
 						glEndList();
 						drawCircle();
@@ -975,7 +1079,6 @@ drawShip()
 			glVertex2d(ship.x - sqrt(ship.size)*cos(ship.phi), ship.y + sqrt(ship.size)*sin(ship.phi));
 
 			glEnd();
-			glFlush();
 		}
 	}
 }
@@ -987,17 +1090,13 @@ drawPhoton(Photon *p)
 	 * Draw a photon with it's vertexes at a varying distance from the origin
 	 */
 	int i;
+	Coords outline[40];
 
-	glColor3f(0.0, 0.0, 1.0);
-    circle = glGenLists(1);
-    glNewList(circle, GL_COMPILE);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glBegin(GL_POLYGON);
-    for(i=0; i<40; i++)
-    	glVertex2d(p->x + cos(i*M_PI/20.0)*photonSize + myRandom(-0.1, 0.1)*photonSize, p->y + sin(i*M_PI/20.0)*photonSize + myRandom(-0.1, 0.1)*photonSize);
-    glEnd();
-    glEndList();
-    drawCircle();
+    for(i=0; i<40; i++){
+    	outline[i].x = p->x + cos(i*M_PI/20.0)*photonSize + effectRandom(-0.1, 0.1)*photonSize;
+    	outline[i].y = p->y + sin(i*M_PI/20.0)*photonSize + effectRandom(-0.1, 0.1)*photonSize;
+    }
+    batchFan(p->x, p->y, outline, 40, 1, 0.0, 0.0, 1.0);
 }
 
 void
@@ -1007,30 +1106,12 @@ drawAsteroid(Asteroid *a)
 	/*
 	 * Draw two asteroids, an white outer shell and an inner black polygon, which is 90% the white shell's radius
 	 */
-	int i;
 
 	/* Draw the white outer ring */
-	glColor3f(1, 1, 1);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glBegin(GL_POLYGON);
-	for(i = 0; i < a->nVertices; i++){
-		glVertex2d(a->x + sqrt(pow(a->coords[i].x, 2) + pow(a->coords[i].y, 2))*sin((a->phi)+i*(2*M_PI)/a->nVertices)
-				, a->y + sqrt(pow(a->coords[i].x, 2) + pow(a->coords[i].y, 2))*cos((a->phi)+i*(2*M_PI)/a->nVertices));
-	}
-	glEnd();
-	glFlush();
+	batchFan(a->x, a->y, a->vertex, a->nVertices, 1, 1, 1, 1);
 
 	/* Draw the asteroid's inner black polygon */
-	glColor3f(0, 0, 0);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glBegin(GL_POLYGON);
-	for(i = 0; i < a->nVertices; i++){
-		glVertex2d(a->x + sqrt(pow(a->coords[i].x*0.95, 2) + pow(a->coords[i].y*0.95, 2))*sin((a->phi)+i*(2*M_PI)/a->nVertices)
-				, a->y + sqrt(pow(a->coords[i].x*0.95, 2) + pow(a->coords[i].y*0.95, 2))*cos((a->phi)+i*(2*M_PI)/a->nVertices));
-	}
-	glEnd();
-	glFlush();
-
+	batchFan(a->x, a->y, a->vertex, a->nVertices, 0.95, 0, 0, 0);
 }
 
 void
@@ -1039,26 +1120,22 @@ drawBackground(BackgroundStar *s)
 	/*
 	 * Draw a single pixel at the star's location and slowly fade in and out
 	 */
-
-    glColor3f(sin(s->flicker), sin(s->flicker), sin(s->flicker));
-    glBegin(GL_POINTS);
-    glVertex2i(s->x, s->y);
-    glEnd();
-    glFlush();
+    batchMode(GL_POINTS);
+    batchVertex((int) s->x, (int) s->y, sin(s->flicker), sin(s->flicker), sin(s->flicker));
 }
 
 void
-drawDust(Dust *d)
+drawDust()
 {
 	/*
 	 * Draw each unit of dust. Once a dust piece's lifetime reaches bellow 60 ticks, start fading
 	 */
+	int i;
 
-	glColor3f(d->lifetime/60.0, d->lifetime/60.0, d->lifetime/60.0);
-	glBegin(GL_POINTS); // render with points
-	glVertex2d(d->x, d->y);
-	glEnd();
-	glFlush();
+	batchMode(GL_POINTS); // render with points
+	for(i = 0; i < dust.live; i++){
+		batchVertex(dust.x[i], dust.y[i], dust.lifetime[i]/60.0, dust.lifetime[i]/60.0, dust.lifetime[i]/60.0);
+	}
 }
 
 void
@@ -1072,73 +1149,56 @@ drawDebris(Debris *d)
 	 * a large sum of points along with a random upgrade to the user
 	 */
 	int i;
+	double r, g, b;
 
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glBegin(GL_TRIANGLE_FAN);
+	r = g = b = 1;
 	if(d->type == 0){
 		//make the ship pieces oscillate a red flash like when the ship has low HP
-		glColor3f((sin(oscillating) + 0.5), 0.5, 0.5);
+		r = sin(oscillating) + 0.5;
+		g = 0.5;
+		b = 0.5;
 	}
 	if(d->type == 1){
 		//give asteroid pieces a slight random shimmer
-		glColor3f(1 - myRandom(0.0, 0.2), 1 - myRandom(0.0, 0.2), 1 - myRandom(0.0, 0.2));
+		r = 1 - effectRandom(0.0, 0.2);
+		g = 1 - effectRandom(0.0, 0.2);
+		b = 1 - effectRandom(0.0, 0.2);
 	}
 	if(d->type == 2){
 		//make the upgrade pieces be gold and randomly shimmer to green
-		glColor3f(0.85*myRandom(1.3, 0.7), 0.65*myRandom(1.3, 0.7), 0.15*myRandom(1.3, 0.7));
+		r = 0.85*effectRandom(1.3, 0.7);
+		g = 0.65*effectRandom(1.3, 0.7);
+		b = 0.15*effectRandom(1.3, 0.7);
 	}
 	/* Draw the debri's vertexes */
-	glBegin(GL_POLYGON);
+	batchMode(GL_TRIANGLES);
 	for(i = 0; i < 3; i++){
-		glVertex2d(d->x + sin(d->phi)*d->coords[i].x,
-				d->y + cos(d->phi)*d->coords[i].y);
+		batchVertex(d->x + sin(d->phi)*d->coords[i].x, d->y + cos(d->phi)*d->coords[i].y, r, g, b);
 	}
-	glEnd();
-	glFlush();
 }
 
 void
 drawScore()
 {
 	/*
-	 * Show the user how much metal and alloys thet have on the top left. This is done by finding the amount of
-	 * digits in the score, then cycling through the score amount backwards to print it in the value correct order.
+	 * Show the user how much metal and alloys thet have on the top left.
 	 *
 	 * The amount of metal and alloy a user has is they current amount + the amout they picked up so far in the current session.
 	 * If they die, they wont gain the metal/alloy they picked up. They need to escape the asteroid field to keep the metal/alloy.
 	 */
-	int i, s;
+	char text[32];
 
 	/* draw the user's total metal */
 	glColor3f(1, 1, 1);
 	glRasterPos2i(1, yMax - 2);
-	drawString("metals:");
-	i = 0;
-	for(s = metalCount + player.metal; s > 0; s = s/10){
-		i++;
-	}
-	for(s = metalCount + player.metal; i > 0; i--){
-		glutBitmapCharacter(GLUT_BITMAP_9_BY_15, (s/((int) pow(10,i-1)))%(10) + '0');
-	}
-	if(metalCount + player.metal == 0){
-		glutBitmapCharacter(GLUT_BITMAP_9_BY_15, '0');
-	}
+	sprintf(text, "metals:%d", (int) (metalCount + player.metal));
+	drawString(text);
 
 	/* draw the user's total alloy */
 	glColor3f(1, 1, 1);
 	glRasterPos2i(1, yMax - 5);
-	drawString("alloys:");
-
-	i = 0;
-	for(s = alloyCount + player.alloy; s > 0; s = s/10){
-		i++;
-	}
-	for(s = alloyCount + player.alloy; i > 0; i--){
-		glutBitmapCharacter(GLUT_BITMAP_9_BY_15, (s/((int) pow(10,i-1)))%(10) + '0');
-	}
-	if(alloyCount + player.alloy == 0){
-		glutBitmapCharacter(GLUT_BITMAP_9_BY_15, '0');
-	}
+	sprintf(text, "alloys:%d", (int) (alloyCount + player.alloy));
+	drawString(text);
 }
 
 void
@@ -1170,7 +1230,7 @@ drawUpgrade()
 	glColor3f(0, 1, 0);
 	glRasterPos2f(xMax*0.82, yMax*0.98);
 	for(i = 0; i < photonUpgrade; i++){
-		glutBitmapCharacter(GLUT_BITMAP_9_BY_15, 'O');
+		drawCharacter('O');
 	}
 
 	glColor3f(1, 1, 1);
@@ -1179,7 +1239,7 @@ drawUpgrade()
 	glColor3f(0, 1, 0);
 	glRasterPos2f(xMax*0.82, yMax*0.95);
 	for(i = 0; i < ship.shipUpgrade; i++){
-		glutBitmapCharacter(GLUT_BITMAP_9_BY_15, 'O');
+		drawCharacter('O');
 	}
 }
 
@@ -1196,11 +1256,11 @@ drawTitle()
 	/* Draw the title of ASTEROIDS. Have it occupy 80% width, 50% height*/
 	glLineWidth(2);
 	glBegin(GL_LINES);
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	glVertex2f(xMax*0.05, yMax*0.9);
 	glVertex2f(xMax*0.95, yMax*0.9);
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	glVertex2f(xMax*0.95, yMax*0.6);
 	glVertex2f(xMax*0.05, yMax*0.6);
@@ -1221,7 +1281,7 @@ drawTitle()
 	currentSpaceCount = 0;
 	startPosition = 0.10 + textWidth*currentLetterCount + spaceWidth*currentSpaceCount;
 	/* Draw the A */
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	glVertex2f(xMax*startPosition, yMax*textMinHeight);
 	glVertex2f(xMax*startPosition, yMax*textMinHeight + yMax*(textMaxHeight-textMinHeight)*2/3);
@@ -1238,7 +1298,7 @@ drawTitle()
 	startPosition = 0.10 + 0.08*currentLetterCount + 0.01*currentSpaceCount;
 
 	/* Draw the S */
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	currentLetterCount++;
 	glVertex2f(xMax*startPosition, yMax*textMinHeight);
@@ -1255,7 +1315,7 @@ drawTitle()
 	startPosition = 0.10 + 0.08*currentLetterCount + 0.01*currentSpaceCount;
 
 	/* Draw the T */
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	currentLetterCount++;
 	glVertex2f(xMax*startPosition, yMax*textMaxHeight);
@@ -1266,7 +1326,7 @@ drawTitle()
 	startPosition = 0.10 + 0.08*currentLetterCount + 0.01*currentSpaceCount;
 
 	/* Draw the E */
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	currentLetterCount++;
 	glVertex2f(xMax*startPosition, yMax*textMinHeight);
@@ -1281,7 +1341,7 @@ drawTitle()
 	startPosition = 0.10 + 0.08*currentLetterCount + 0.01*currentSpaceCount;
 
 	/* Draw the R */
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	currentLetterCount++;
 	glVertex2f(xMax*startPosition, yMax*textMinHeight);
@@ -1298,7 +1358,7 @@ drawTitle()
 	startPosition = 0.10 + 0.08*currentLetterCount + 0.01*currentSpaceCount;
 
 	/* Draw the O */
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	currentLetterCount++;
 	glVertex2f(xMax*startPosition, yMax*textMinHeight);
@@ -1313,7 +1373,7 @@ drawTitle()
 	startPosition = 0.10 + 0.08*currentLetterCount + 0.01*currentSpaceCount;
 
 	/* Draw the I */
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	currentLetterCount++;
 	glVertex2f(xMax*startPosition, yMax*textMaxHeight);
@@ -1326,7 +1386,7 @@ drawTitle()
 	startPosition = 0.10 + 0.08*currentLetterCount + 0.01*currentSpaceCount;
 
 	/* Draw the D */
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	currentLetterCount++;
 	glVertex2f(xMax*startPosition, yMax*textMinHeight);
@@ -1341,7 +1401,7 @@ drawTitle()
 	startPosition = 0.10 + 0.08*currentLetterCount + 0.01*currentSpaceCount;
 
 	/* Draw the S */
-	color = myRandom(0.7, 1.5);
+	color = effectRandom(0.7, 1.5);
 	glColor3f(color, color, color);
 	currentLetterCount++;
 	glVertex2f(xMax*startPosition, yMax*textMinHeight);
@@ -1387,7 +1447,6 @@ drawTitle()
 
 
 	glEnd();
-	glFlush();
 }
 
 void
@@ -1702,7 +1761,7 @@ drawLevelText()
 					sprintf(number, "%d", (int) (score/pow(10, (centerOffsetScoreValue - 1 - i)))%10);
 					drawString(number);
 				}else{
-					sprintf(number, "%d", (int) myRandom(0, 9));
+					sprintf(number, "%d", (int) effectRandom(0, 9));
 					drawString(number);
 				}
 			}
@@ -1724,13 +1783,28 @@ void
 drawString(char* s)
 {
 	/*
-	 * Draw the given string using GLUT's character printer
+	 * Draw the given string at the current raster position by calling the display list of each of it's characters at once
+	 */
+
+	if(glyphList == 0){
+		buildGlyphs();
+	}
+	glListBase(glyphList);
+	glCallLists(strlen(s), GL_UNSIGNED_BYTE, s);
+	glListBase(0);
+}
+
+void
+drawCharacter(char c)
+{
+	/*
+	 * Draw a single character at the current raster position
 	 */
-	int i;
 
-	for(i = 0; s[i] != '\0'; i++){
-		glutBitmapCharacter(GLUT_BITMAP_9_BY_15, s[i]);
+	if(glyphList == 0){
+		buildGlyphs();
 	}
+	glCallList(glyphList + c);
 }
 
 
@@ -1864,25 +1938,12 @@ void
 advanceDust()
 {
 	/*
-	 * Advance the dust particles and reduce their lifetime. Once it reaches 0, deactivate the dust
+	 * Advance the dust particles and reduce their lifetime. Once it reaches 0, remove the dust
 	 */
-	int i;
 
-	for(i = 0; i < MAX_DUST; i++){
-		if(dust[i].active){
-			dust[i].x += dust[i].dx;
-	    	dust[i].y += dust[i].dy;
-	        //decelerate the particles. Not realistic, but looks good
-	        dust[i].dx *= 0.99;
-	        dust[i].dy *= 0.99;
-
-	        //reduce the lifetime and deactivate the dust if needed
-	        dust[i].lifetime--;
-	         if(dust[i].lifetime <= 0){
-	        	 dust[i].active = 0;
-	     	}
-		}
-	}
+	//decelerate the particles. Not realistic, but looks good
+	integrateParticles(&dust, 0.99);
+	removeExpiredParticles(&dust);
 }
 
 void
@@ -1895,25 +1956,25 @@ advanceDebris()
      */
 	int i;
 
-    for(i = 0; i <MAX_DEBRIS; i++){
-    	if(debris[i].active){
-    		debris[i].lifetime--;
-    		debris[i].x += debris[i].dx;
-    		debris[i].y += debris[i].dy;
-    		debris[i].phi += debris[i].dphi;
-    		debris[i].dx *= 0.99;
-    		debris[i].dy *= 0.99;
-    		debris[i].dphi *= 0.99;
-    		/* prevent the debri's phi from overflowing */
-    		if(debris[i].phi > 2*M_PI){
-    			debris[i].phi -= 2*M_PI;
-    		}else if(debris[i].phi < 0){
-    			debris[i].phi += 2*M_PI;
-    		}
-    		if(debris[i].lifetime <= 0){
-    			destroyDebris(&debris[i]);
-    		}
-    	}
+    for(i = 0; i < liveDebris; i++){
+		debris[i].lifetime--;
+		debris[i].x += debris[i].dx;
+		debris[i].y += debris[i].dy;
+		debris[i].phi += debris[i].dphi;
+		debris[i].dx *= 0.99;
+		debris[i].dy *= 0.99;
+		debris[i].dphi *= 0.99;
+		/* prevent the debri's phi from overflowing */
+		if(debris[i].phi > 2*M_PI){
+			debris[i].phi -= 2*M_PI;
+		}else if(debris[i].phi < 0){
+			debris[i].phi += 2*M_PI;
+		}
+		/* destroying the debris moves the last live debris into this slot, so check it again */
+		if(debris[i].lifetime <= 0){
+			destroyDebris(&debris[i]);
+			i--;
+		}
     }
 }
 
@@ -2018,12 +2079,13 @@ advancePhoton()
      * */
 	int i;
 
-	for(i = 0; i < MAX_PHOTONS; i++){
+	for(i = 0; i < photonCapacity; i++){
 		if(photons[i].active){
 			photons[i].x += photons[i].dx;
 			photons[i].y += photons[i].dy;
 			if(photons[i].x < -photonSize || photons[i].x > xMax+photonSize || photons[i].y < -photonSize || photons[i].y > yMax+photonSize){
 				photons[i].active = 0;
+				releaseSlot(&photonSlots, i);
 			}
 		}
 	}
@@ -2036,24 +2098,20 @@ advanceAsteroid(){
      * the entire list is full of inactive asteroids, increase the
      * level variable and spawn more asteroids relative to the current level
      */
-	int i, empty;
-	empty = 1;
-	for(i = 0; i < MAX_ASTEROIDS; i++){
-		if(asteroids[i].active){
-			empty = 0;
-			asteroids[i].x += asteroids[i].dx;
-			asteroids[i].y += asteroids[i].dy;
-			asteroids[i].phi += asteroids[i].dphi;
-			if(asteroids[i].phi > 2*M_PI){
-				asteroids[i].phi -= 2*M_PI;
-			}else if(asteroids[i].phi < 0){
-				asteroids[i].phi += 2*M_PI;
-			}
+	int i;
+	for(i = 0; i < liveAsteroids; i++){
+		asteroids[i].x += asteroids[i].dx;
+		asteroids[i].y += asteroids[i].dy;
+		asteroids[i].phi += asteroids[i].dphi;
+		if(asteroids[i].phi > 2*M_PI){
+			asteroids[i].phi -= 2*M_PI;
+		}else if(asteroids[i].phi < 0){
+			asteroids[i].phi += 2*M_PI;
 		}
 	}
 
-	/* If all the asteroids have become inactive, set the timer to advance to the next level */
-	if(empty && levelTextLifetime == -1){
+	/* If all the asteroids have been destroyed, set the timer to advance to the next level */
+	if(liveAsteroids == 0 && levelTextLifetime == -1){
 		levelTextLifetime = 120;
 		if(level == maxLevel){
 			/* Extend the level complete timer if it was the final level */
@@ -2062,41 +2120,41 @@ advanceAsteroid(){
 	}
 
 	/* roll the asteroids to the other side of the screen if they pass the edge of the screen */
-	for(i = 0; i < MAX_ASTEROIDS; i++){
-		if(asteroids[i].active){
-			//Too far left, move to the right side
-			if(asteroids[i].x < -1*MAX_ASTEROID_VARIANCE*asteroids[i].size){
-				asteroids[i].x = xMax + MAX_ASTEROID_VARIANCE*asteroids[i].size;
-			}
-			//Too far right, move to the left side
-			else if(asteroids[i].x > xMax + MAX_ASTEROID_VARIANCE*asteroids[i].size){
-				asteroids[i].x = -1*MAX_ASTEROID_VARIANCE*asteroids[i].size;
-			}
-			//Too far down, move to the top side
-			if(asteroids[i].y < -1*MAX_ASTEROID_VARIANCE*asteroids[i].size){
-				asteroids[i].y = yMax + MAX_ASTEROID_VARIANCE*asteroids[i].size;
-			}
-			//Too far up, move to the bottom side
-			else if(asteroids[i].y > xMax + MAX_ASTEROID_VARIANCE*asteroids[i].size){
-				asteroids[i].y = -1*MAX_ASTEROID_VARIANCE*asteroids[i].size;
-			}
+	for(i = 0; i < liveAsteroids; i++){
+		//Too far left, move to the right side
+		if(asteroids[i].x < -1*MAX_ASTEROID_VARIANCE*asteroids[i].size){
+			asteroids[i].x = xMax + MAX_ASTEROID_VARIANCE*asteroids[i].size;
+		}
+		//Too far right, move to the left side
+		else if(asteroids[i].x > xMax + MAX_ASTEROID_VARIANCE*asteroids[i].size){
+			asteroids[i].x = -1*MAX_ASTEROID_VARIANCE*asteroids[i].size;
 		}
+		//Too far down, move to the top side
+		if(asteroids[i].y < -1*MAX_ASTEROID_VARIANCE*asteroids[i].size){
+			asteroids[i].y = yMax + MAX_ASTEROID_VARIANCE*asteroids[i].size;
+		}
+		//Too far up, move to the bottom side
+		else if(asteroids[i].y > xMax + MAX_ASTEROID_VARIANCE*asteroids[i].size){
+			asteroids[i].y = -1*MAX_ASTEROID_VARIANCE*asteroids[i].size;
+		}
+
+		/* Save the asteroid's vertices for this tick's collisions and rendering */
+		updateAsteroidVertices(&asteroids[i]);
 	}
 }
 
 void
 advancePoints(){
     /*
-     * Move the points' position upwards. Decrement it's lifetime and set it to inactive once it's 0
+     * Move the points' position upwards. Decrement it's lifetime and remove it once it's 0
      */
 	int i;
-    for(i = 0; i < MAX_POINTS; i++){
-        if(points[i].active){
-            points[i].y += 0.1;
-        }
+    for(i = 0; i < livePoints; i++){
+        points[i].y += 0.1;
         points[i].lifetime--;
         if(points[i].lifetime <= 0){
-            points[i].active = 0;
+            removePoints(i);
+            i--;
         }
     }
 }
@@ -2105,61 +2163,82 @@ void
 collisionAsteroidPhoton(){
 	/*
 	 * Detect collisions with active asteroids and active photons by
-	 * using circle-cirlce and circle-polygon collision detection
+	 * using circle-cirlce and circle-polygon collision detection. Only the photons found near an asteroid by the collision grid are checked.
+	 * Each photon is swept along the path it took this tick so a fast photon cannot pass through an asteroid's edge between ticks
 	 */
-	int i, j, k;
+	int i, j, k, n, count, live;
 	double x0, x1, x2, y0, y1, y2, lambda, dist;
-	for(i = 0; i < MAX_ASTEROIDS; i++){
-		for(j = 0; j < MAX_PHOTONS; j++){
+	double startX, startY;
+
+	/* Place the active photons onto the collision grid. A photon covers the whole path it travelled this tick */
+	resetCollisionGrid(&collisionGrid);
+	for(j = 0; j < photonCapacity; j++){
+		if(photons[j].active){
+			insertCollisionGrid(&collisionGrid, j, photons[j].x - photons[j].dx/2, photons[j].y - photons[j].dy/2,
+					photonSize + sqrt(pow(photons[j].dx, 2) + pow(photons[j].dy, 2))/2);
+		}
+	}
+	buildCollisionGrid(&collisionGrid);
+
+	for(i = 0; i < liveAsteroids; i++){
+		live = liveAsteroids;
+		count = queryCollisionGrid(&collisionGrid, asteroids[i].x, asteroids[i].y, asteroids[i].size*MAX_ASTEROID_VARIANCE);
+		for(n = 0; n < count; n++){
+			j = collisionGrid.result[n];
 			if(photons[j].active && asteroids[i].active){
-				/* check whether the photons are close to an asteroid by comparing their radius.
-				* If a photon is within the asteroids minimum circle, which has a radius of
-				* MIN_ASTEROID_VARIANCE*size, then it is impossible for the photon's origin
-				* to NOT be in contact with the asteroid. */
-				if(pow(asteroids[i].x - photons[j].x,2) + pow(asteroids[i].y - photons[j].y,2) <=
+				/* Find where the photon started this tick relative to the asteroid. Both of them moved this tick,
+				 * so the asteroid's velocity is removed to get the path the photon took past the asteroid */
+				startX = photons[j].x - (photons[j].dx - asteroids[i].dx);
+				startY = photons[j].y - (photons[j].dy - asteroids[i].dy);
+
+				/* check whether the photon's path comes close to an asteroid by comparing their radius.
+				* If a photon's path is within the asteroids minimum circle, which has a radius of
+				* MIN_ASTEROID_VARIANCE*size, then it is impossible for the photon to NOT be in contact with the asteroid. */
+				if(segmentDistance(asteroids[i].x, asteroids[i].y, startX, startY, photons[j].x, photons[j].y) <=
 					pow(asteroids[i].size*MAX_ASTEROID_VARIANCE + photonSize,2)){
-					/* photon is touching the asteroids minimum circle, impossible to miss */
-					if(pow(asteroids[i].x - photons[j].x,2) + pow(asteroids[i].y - photons[j].y,2) <=
+					/* photon's path is touching the asteroids minimum circle, impossible to miss */
+					if(segmentDistance(asteroids[i].x, asteroids[i].y, startX, startY, photons[j].x, photons[j].y) <=
 							pow(asteroids[i].size*MIN_ASTEROID_VARIANCE + photonSize,2)){
 						//Photon destroys asteroid with a circle-circle check
 					    destroyAsteroid(&asteroids[i], &photons[j]);
-					    i = MAX_ASTEROIDS;
-					    j = MAX_PHOTONS;
+					    i = liveAsteroids;
+					    n = count;
 					/* photon is within/touching the maximum circle, but not the minimum circle */
 					}else{
 					    /*Check whether a collision has happened using the astroid's vertices and
 					     *the photon's radius. Start by checking the first and last vertex' line*/
-					    x1 = asteroids[i].x + sqrt(pow(asteroids[i].coords[asteroids[i].nVertices-1].x, 2) + pow(asteroids[i].coords[asteroids[i].nVertices-1].y, 2))*sin((asteroids[i].phi)+(asteroids[i].nVertices-1)*(2*M_PI)/asteroids[i].nVertices);
-					    y1 = asteroids[i].y + sqrt(pow(asteroids[i].coords[asteroids[i].nVertices-1].x, 2) + pow(asteroids[i].coords[asteroids[i].nVertices-1].y, 2))*cos((asteroids[i].phi)+(asteroids[i].nVertices-1)*(2*M_PI)/asteroids[i].nVertices);
+					    x1 = asteroids[i].vertex[asteroids[i].nVertices-1].x;
+					    y1 = asteroids[i].vertex[asteroids[i].nVertices-1].y;
 				    	for(k = 0; k < asteroids[i].nVertices; k++){
 						    x0 = photons[j].x;
 					    	y0 = photons[j].y;
 					    	/* set the vertexes to the next line of the asteroid */
 					    	x2 = x1;
 						    y2 = y1;
-						    x1 = asteroids[i].x + sqrt(pow(asteroids[i].coords[k].x, 2) + pow(asteroids[i].coords[k].y, 2))*sin((asteroids[i].phi)+k*(2*M_PI)/asteroids[i].nVertices);
-					    	y1 = asteroids[i].y + sqrt(pow(asteroids[i].coords[k].x, 2) + pow(asteroids[i].coords[k].y, 2))*cos((asteroids[i].phi)+k*(2*M_PI)/asteroids[i].nVertices);
+						    x1 = asteroids[i].vertex[k].x;
+					    	y1 = asteroids[i].vertex[k].y;
 
 						    lambda = ((x0 - x1)*(x2 - x1) + (y0 -y1)*(y2 - y1)) / ( pow((x2 - x1),2) + pow((y2 - y1),2) );
 						    dist = pow((x1 - x0 + lambda*(x2 - x1)),2) + pow((y1 - y0 + lambda*(y2 - y1)),2);
-						    /* This if statement only checks if the photon touches a vertexof the asteroid.
-						     * A photon can pass the vertex and get inside the asteroid if they are both moving
-						     * at each other fast enough for the distance they cover to be over twice the length
-						     * of the photon's radius in one frame. Having  a photon pass through an asteroid
-						     * becomes more difficult the closer it is heading towards the center due To the
-						     * minimum asteroid variance check. But, the more the photon is pointed towards the
-						     * edge, the easier the photon can pass through the asteroid. */
-					    	if((lambda >= 0 && lambda <=1 && dist <= pow(photonSize,2))){
+						    /* The photon hits the edge if it is within it's radius of the edge, or if the path it took
+						     * this tick crosses the edge. The path check stops fast photons from passing through the
+						     * edge when the distance they cover in one tick is over twice the photon's radius */
+					    	if((lambda >= 0 && lambda <=1 && dist <= pow(photonSize,2)) ||
+					    			lineCollision(startX, startY, x0, y0, x1, y1, x2, y2)){
 							    //Photon destroys asteroid with a polygon-circle check
 							    destroyAsteroid(&asteroids[i], &photons[j]);
 						    	k = asteroids[i].nVertices;
-					    		j = MAX_PHOTONS;
+					    		n = count;
 						    }
 				    	}
 					}
 				}
 			}
 		}
+		/* A fully destroyed asteroid has the last live asteroid moved into it's slot, so check the slot again */
+		if(liveAsteroids < live){
+			i--;
+		}
 	}
 }
 
@@ -2168,85 +2247,47 @@ collisionAsteroidShip()
 {
 	/*
 	 * Depending on the ship type, check for collisions with the ship and the active asteroids.
-	 * Once a ship gets a "direct collision" (when a line-line collision is met for a type 0 and 1,
+	 * Once a ship gets a "direct collision" (when an edge of the ship's hull crosses an edge of the asteroid for a type 0 and 1,
 	 * while a simple circle-circle collision is met with a type 2), it cannot get hit with another
 	 * "direct collision" until it's Dmg variable is back to 0. It will still take "tick damage"
-	 * (Hp-- for simply being too close to the asteroid) independent of the Dmg variables though
+	 * (Hp-- for simply being too close to the asteroid) independent of the Dmg variables though.
+	 * Only the asteroids found near the ship by the collision grid are checked
 	 */
-	int i, k, count;
-	double x1, x2, y1, y2, angle;
-
-	for(i = 0; i < MAX_ASTEROIDS; i++){
-		/* Track the values of the asteroid's final vertex to be used with the asteroids
-		 * first vertex as the first line when checking for polygon-polygon collisions */
-	    x1 = asteroids[i].x + sqrt(pow(asteroids[i].coords[asteroids[i].nVertices-1].x, 2) + pow(asteroids[i].coords[asteroids[i].nVertices-1].y, 2))*sin((asteroids[i].phi)+(asteroids[i].nVertices-1)*(2*M_PI)/asteroids[i].nVertices);
-	    y1 = asteroids[i].y + sqrt(pow(asteroids[i].coords[asteroids[i].nVertices-1].x, 2) + pow(asteroids[i].coords[asteroids[i].nVertices-1].y, 2))*cos((asteroids[i].phi)+(asteroids[i].nVertices-1)*(2*M_PI)/asteroids[i].nVertices);
-
-	    if(ship.type == 0){
-			/*check whether the asteroid is active and if the ship is within it's max range*/
-			if(asteroids[i].active && pow(asteroids[i].x - ship.x,2) + pow(asteroids[i].y - ship.y,2) <=
-					pow(asteroids[i].size*MAX_ASTEROID_VARIANCE + ship.size,2)){
-
-				/* Check each asteroid's vertex to see whether any of the ship's vertexes are touching the asteroid */
-				for(k = 0; k < asteroids[i].nVertices; k++){
-					x2 = x1;
-					y2 = y1;
-					x1 = asteroids[i].x + sqrt(pow(asteroids[i].coords[k].x, 2) + pow(asteroids[i].coords[k].y, 2))*sin((asteroids[i].phi)+k*(2*M_PI)/asteroids[i].nVertices);
-					y1 = asteroids[i].y + sqrt(pow(asteroids[i].coords[k].x, 2) + pow(asteroids[i].coords[k].y, 2))*cos((asteroids[i].phi)+k*(2*M_PI)/asteroids[i].nVertices);
-
-					//check for collision with the ship's right side
-					if(lineCollision(
-							//ship's back right dot
-							ship.x + sqrt(ship.size)*sin(ship.phi + (135*M_PI/180)), ship.y + sqrt(ship.size)*cos(ship.phi + (135*M_PI/180)),
-							//ship's nose dot
-							ship.x + ship.size*sin(ship.phi), ship.y + ship.size*cos(ship.phi),
-							//asteroid's vertex dots
-							x1, y1, x2, y2)){
-						if(ship.RDmg == 0 && ship.RHp > 0){
-							ship.RHp -= 20;
-							ship.RDmg = 50;
-							if(ship.RHp <= 0){
-								destroyShip(ship);
-							}
-						}
-					}
-
-					//check for collision with the ship's left side
-					if(lineCollision(
-							//ship's back left dot
-							ship.x + sqrt(ship.size)*sin(ship.phi + (225*M_PI/180)), ship.y + sqrt(ship.size)*cos(ship.phi + (225*M_PI/180)),
-							//ship's nose dot
-							ship.x + ship.size*sin(ship.phi), ship.y + ship.size*cos(ship.phi),
-							//asteroid's vertex dots
-							x1, y1, x2, y2)){
-						if(ship.LDmg == 0 && ship.LHp > 0){
-							ship.LHp -= 20;
-							ship.LDmg = 50;
-							if(ship.LHp <= 0){
-								destroyShip(ship);
-							}
-						}
-					}
-
-					//check for collision with the ship's back side
-					if(lineCollision(
-							//ship's back left dot
-							ship.x + sqrt(ship.size)*sin(ship.phi + (225*M_PI/180)), ship.y + sqrt(ship.size)*cos(ship.phi + (225*M_PI/180)),
-							//ship's back right dot
-							ship.x + sqrt(ship.size)*sin(ship.phi + (135*M_PI/180)), ship.y + sqrt(ship.size)*cos(ship.phi + (135*M_PI/180)),
-
-							//asteroid's vertex dots
-							x1, y1, x2, y2)){
-						if(ship.BDmg == 0 && ship.BHp > 0){
-							ship.BHp -= 20;
-							ship.BDmg = 50;
-							if(ship.BHp <= 0){
-								destroyShip(ship);
-							}
-						}
-					}
+	int i, k, n, count, nearCount, hitEdges, hitParts;
+	double angle;
+	double particleX, particleY, particleDx, particleDy;
+	const ShipHull *hull = &shipHulls[ship.type];
+
+	/* Place the active asteroids onto the collision grid and find the ones near the ship */
+	resetCollisionGrid(&collisionGrid);
+	for(i = 0; i < liveAsteroids; i++){
+		insertCollisionGrid(&collisionGrid, i, asteroids[i].x, asteroids[i].y, asteroids[i].size*MAX_ASTEROID_VARIANCE);
+	}
+	buildCollisionGrid(&collisionGrid);
+	nearCount = queryCollisionGrid(&collisionGrid, ship.x, ship.y, ship.size);
+	updateShipHull();
+
+	for(n = 0; n < nearCount; n++){
+		i = collisionGrid.result[n];
+
+		/* Ships with a hull take direct hits on the parts whose edges cross the asteroid's edges */
+		if(hull->nVertices > 0 && asteroids[i].active && pow(asteroids[i].x - ship.x,2) + pow(asteroids[i].y - ship.y,2) <=
+				pow(asteroids[i].size*MAX_ASTEROID_VARIANCE + ship.size,2)){
+			hitEdges = polygonCollision(shipHullVertex, hull->nVertices, asteroids[i].vertex, asteroids[i].nVertices);
+			hitParts = 0;
+			for(k = 0; k < hull->nVertices; k++){
+				if(hitEdges & (1 << k)){
+					hitParts |= 1 << hull->vertex[k].part;
+				}
+			}
+			for(k = SHIP_PART_RIGHT; k <= SHIP_PART_BACK; k++){
+				if(hitParts & (1 << k)){
+					hitShipPart(k, hull->damage, hull->delay);
 				}
 			}
+		}
+
+	    if(ship.type == 0){
 			/* Check whether the ship is too much inside the asteroid (the ship's origin is touching the asteroid's inner circle)
 			 * Decrement the ship's health when inside said radius and trigger a damage event on each piece of the ship.
 			 * Also, give the ship an increase in speed away from the asteroid's origin */
@@ -2296,74 +2337,6 @@ collisionAsteroidShip()
 				}
 			}
 	    }else if(ship.type == 1){
-			/*check whether the asteroid is active and if the ship is within it's max range */
-			if(asteroids[i].active && pow(asteroids[i].x - ship.x,2) + pow(asteroids[i].y - ship.y,2) <=
-					pow(asteroids[i].size*MAX_ASTEROID_VARIANCE + ship.size,2)){
-
-				/* Check each asteroid's vertex to see whether the ship's vertexes are touching any.
-				  * This ship has only one piece, so only one collision needs to be found to take damage */
-				for(k = 0; k < asteroids[i].nVertices; k++){
-					x2 = x1;
-					y2 = y1;
-					x1 = asteroids[i].x + sqrt(pow(asteroids[i].coords[k].x, 2) + pow(asteroids[i].coords[k].y, 2))*sin((asteroids[i].phi)+k*(2*M_PI)/asteroids[i].nVertices);
-					y1 = asteroids[i].y + sqrt(pow(asteroids[i].coords[k].x, 2) + pow(asteroids[i].coords[k].y, 2))*cos((asteroids[i].phi)+k*(2*M_PI)/asteroids[i].nVertices);
-
-					/* Only run collisions checks if the ship has more than 0 HP */
-					if(ship.BHp > 0){
-						/* Only check for direct vertex collisions if the ship is able to take damage (BDmg <= 0) */
-						if(ship.BDmg == 0){
-							/* check for collision with the ship's right side */
-							if(lineCollision(
-									//ship's top-right dot
-									ship.x + sqrt(ship.size), ship.y + sqrt(ship.size),
-									//ship's bottom-right dot
-									ship.x + sqrt (ship.size), ship.y - sqrt (ship.size),
-									//asteroid's vertex dots
-									x1, y1, x2, y2)){
-								ship.BHp -= 20;
-								ship.BDmg = 30;
-							}else
-							/* check for collisions with the ship's bottom side */
-							if(lineCollision(
-									//ship's bottom-right dot
-									ship.x + sqrt(ship.size), ship.y - sqrt(ship.size),
-									//ship's bottom-left dot
-									ship.x - sqrt (ship.size), ship.y - sqrt (ship.size),
-									//asteroid's vertex dots
-									x1, y1, x2, y2)){
-								ship.BHp -= 20;
-								ship.BDmg = 30;
-							}else
-							/* check for collisions with the ship's left side */
-							if(lineCollision(
-									//ship's bottom-left dot
-									ship.x - sqrt(ship.size), ship.y - sqrt(ship.size),
-									//ship's top-left dot
-									ship.x - sqrt (ship.size), ship.y + sqrt (ship.size),
-									//asteroid's vertex dots
-									x1, y1, x2, y2)){
-								ship.BHp -= 20;
-								ship.BDmg = 30;
-							}else
-							/* check for collisions with the ship's top side */
-							if(lineCollision(
-									//ship's top-left dot
-									ship.x + sqrt(ship.size), ship.y - sqrt(ship.size),
-									//ship's top-right dot
-									ship.x + sqrt (ship.size), ship.y + sqrt (ship.size),
-									//asteroid's vertex dots
-									x1, y1, x2, y2)){
-								ship.BHp -= 20;
-								ship.BDmg = 30;
-							}
-						}
-						/* Destroy the ship if it's out of Hp */
-						if(ship.BHp <= 0){
-							destroyShip(ship);
-						}
-					}
-				}
-			}
 			/* check if the ship is too far within an asteroid's inner circle and is not already destroyed*/
 			if(asteroids[i].active && ship.BDmg != -1 && pow(asteroids[i].x - ship.x,2) + pow(asteroids[i].y - ship.y,2) <=
 					pow(asteroids[i].size*MIN_ASTEROID_VARIANCE,2)){
@@ -2436,20 +2409,12 @@ collisionAsteroidShip()
 					if(ship.LHp <= 0){
 						ship.LHp = 0;
 						/* create 32 dust particles to indicate the shield is "destroyed" */
-						count = 0;
-						for(k = 0; k < MAX_DUST; k++){
-							if(dust[k].active != 1){
-								count++;
-								dust[k].active = 1;
-								dust[k].x = ship.x + ship.size*sin(count*M_PI/16) + myRandom(-0.2, 0.2);
-								dust[k].y = ship.y + ship.size*cos(count*M_PI/16) + myRandom(-0.2, 0.2);
-								dust[k].dx = ship.dx + 0.2*sin(count*M_PI/16) + myRandom(-0.2, 0.2);
-								dust[k].dy = ship.dy + 0.2*cos(count*M_PI/16) + myRandom(-0.2, 0.2);
-								dust[k].lifetime = 45;
-								if(count >= 32){
-									k = MAX_DUST;
-								}
-							}
+						for(count = 1; count <= 32; count++){
+							particleX = ship.x + ship.size*sin(count*M_PI/16) + myRandom(-0.2, 0.2);
+							particleY = ship.y + ship.size*cos(count*M_PI/16) + myRandom(-0.2, 0.2);
+							particleDx = ship.dx + 0.2*sin(count*M_PI/16) + myRandom(-0.2, 0.2);
+							particleDy = ship.dy + 0.2*cos(count*M_PI/16) + myRandom(-0.2, 0.2);
+							addParticle(&dust, particleX, particleY, particleDx, particleDy, 45);
 						}
 					}
 				}else{
@@ -2490,21 +2455,82 @@ collisionAsteroidShip()
 }
 
 void
-collisionDebrisShip()
+updateShipHull()
 {
 	/*
-	 * Check whether the ship collides into a piece of debris (ship radius touches debris origin)
-	 * to give them points and remove the debris to simulate the ship picking up the debris.
-	 * The ship must not be respawning, the debris must be active and not be type 0
+	 * Place the current ship type's hull onto the ship's position and rotation. This is done once per
+	 * tick so the hull's vertices are not recalculated for every asteroid edge they are tested against
 	 */
-	int i;
+	int k;
+	double angle, distance;
+	const ShipHull *hull = &shipHulls[ship.type];
+
+	for(k = 0; k < hull->nVertices; k++){
+		angle = hull->vertex[k].angle + hull->rotates*ship.phi;
+		distance = hull->vertex[k].sizeScale*ship.size + hull->vertex[k].rootScale*sqrt(ship.size);
+		shipHullVertex[k].x = ship.x + distance*sin(angle);
+		shipHullVertex[k].y = ship.y + distance*cos(angle);
+	}
+}
+
+void
+hitShipPart(int part, int damage, int delay)
+{
+	/*
+	 * Give a direct hit to a piece of the ship if it still has health and is able to take a direct hit.
+	 * The ship is destroyed once the piece's health reaches 0
+	 */
+	double *hp;
+	int *dmg;
+
+	if(part == SHIP_PART_RIGHT){
+		hp = &ship.RHp;
+		dmg = &ship.RDmg;
+	}else if(part == SHIP_PART_LEFT){
+		hp = &ship.LHp;
+		dmg = &ship.LDmg;
+	}else{
+		hp = &ship.BHp;
+		dmg = &ship.BDmg;
+	}
+
+	if(*dmg == 0 && *hp > 0){
+		*hp -= damage;
+		*dmg = delay;
+		if(*hp <= 0){
+			destroyShip();
+		}
+	}
+}
+
+void
+collisionDebrisShip()
+{
+	/*
+	 * Check whether the ship collides into a piece of debris (ship radius touches debris origin)
+	 * to give them points and remove the debris to simulate the ship picking up the debris.
+	 * The ship must not be respawning, the debris must be active and not be type 0.
+	 * Only the debris found near the ship by the collision grid are checked
+	 */
+	int i, n, count;
 
 	if(respawn == -1){
-		for(i = 0; i < MAX_DEBRIS; i++){
+		/* Place the debris that can be picked up onto the collision grid and find the ones near the ship */
+		resetCollisionGrid(&collisionGrid);
+		for(i = 0; i < liveDebris; i++){
+			if(debris[i].type != 0){
+				insertCollisionGrid(&collisionGrid, i, debris[i].x, debris[i].y, 0);
+			}
+		}
+		buildCollisionGrid(&collisionGrid);
+		count = queryCollisionGrid(&collisionGrid, ship.x, ship.y, ship.size);
+
+		/* Go through the nearby debris from the highest slot down, since removing a piece moves
+		 * the last live debris into it's slot and that debris was either checked already or is not nearby */
+		for(n = count - 1; n >= 0; n--){
+			i = collisionGrid.result[n];
 			/* check whether the origin of the debris touches the ship's size radius */
-			if(debris[i].active && debris[i].type != 0 && pow(debris[i].x - ship.x,2) + pow(debris[i].y - ship.y,2) <= pow(ship.size,2)){
-				debris[i].active = 0;
-				debris[i].lifetime = 0;
+			if(pow(debris[i].x - ship.x,2) + pow(debris[i].y - ship.y,2) <= pow(ship.size,2)){
 				if(debris[i].type == 2){
 					/* Upon picking up a shining debris piece, increase the score by 100 and give the user some alloys */
 					upgradeShip(ship);
@@ -2517,6 +2543,7 @@ collisionDebrisShip()
 				    debrisM++;
 				    metalCount += (myRandom(1.8, 9.1));
 				}
+				removeDebris(i);
 			}
 		}
 	}
@@ -2643,57 +2670,42 @@ firePhoton()
 	 * Fire a photon in different manners depending on the given ship type. The ship must not be respawning,
 	 * the currentcooldown variable must be 0 and the game expects there to be inactive photons in the array
 	 */
-	int i, fired;
+	int fired;
+	Photon *shot;
 
 	if(ship.type == 0){
 		/* Fire a photon in the direction that the ship is facing */
-		for(i = 0; i < MAX_PHOTONS; i++){
-			if(!(photons[i].active)){
-				photons[i].active = 1;
-				photons[i].x = ship.x + photonSize*sin(ship.phi);
-				photons[i].y = ship.y + photonSize*cos(ship.phi);
-				photons[i].dx = photonSpeed*sin(ship.phi);
-				photons[i].dy = photonSpeed*cos(ship.phi);
-				i = MAX_PHOTONS;
-			}
+		shot = getInactivePhoton();
+		if(shot != NULL){
+			shot->active = 1;
+			shot->x = ship.x + photonSize*sin(ship.phi);
+			shot->y = ship.y + photonSize*cos(ship.phi);
+			shot->dx = photonSpeed*sin(ship.phi);
+			shot->dy = photonSpeed*cos(ship.phi);
 		}
 	}else if(ship.type == 1){
 		/* Fire a photon in all 4 directions. Each shot fired increases cooldown */
 		if(currentCooldown <= 0){
-			fired = 0;
-			for(i = 0; i < MAX_PHOTONS; i++){
-				if(!(photons[i].active)){
-					currentCooldown += cooldown;
-					photons[i].active = 1;
-					photons[i].x = ship.x + photonSize*sin(fired*M_PI/2);
-					photons[i].y = ship.y + photonSize*cos(fired*M_PI/2);
-					photons[i].dx = photonSpeed*sin(fired*M_PI/2);
-					photons[i].dy = photonSpeed*cos(fired*M_PI/2);
-					fired++;
-					if(fired >= 4){
-						i = MAX_PHOTONS;
-					}
-				}
+			for(fired = 0; fired < 4 && (shot = getInactivePhoton()) != NULL; fired++){
+				currentCooldown += cooldown;
+				shot->active = 1;
+				shot->x = ship.x + photonSize*sin(fired*M_PI/2);
+				shot->y = ship.y + photonSize*cos(fired*M_PI/2);
+				shot->dx = photonSpeed*sin(fired*M_PI/2);
+				shot->dy = photonSpeed*cos(fired*M_PI/2);
 			}
 		}
 	}else if(ship.type == 2){
 		/* fire 3 photon shots, two of which are offset to either sides of the ship. Each shot increases the cooldown */
 		if(currentCooldown <= 0){
-			fired = 0;
-			for(i = 0; i < MAX_PHOTONS; i++){
-				if(!(photons[i].active)){
-					currentCooldown += cooldown;
-					photons[i].active = 1;
-					photons[i].x = ship.x + (fired == 0)*ship.size*sin(ship.phi) + (fired == 1)*ship.size*cos(ship.phi + (330*M_PI/180)) - (fired == 2)*ship.size*cos(ship.phi + (30*M_PI/180)) + photonSize*sin(ship.phi);
-					photons[i].y = ship.y + (fired == 0)*ship.size*cos(ship.phi) - (fired == 1)*ship.size*sin(ship.phi + (330*M_PI/180)) + (fired == 2)*ship.size*sin(ship.phi + (30*M_PI/180)) + photonSize*cos(ship.phi);
-
-					photons[i].dx = photonSpeed*sin(ship.phi);
-					photons[i].dy = photonSpeed*cos(ship.phi);
-					fired++;
-					if(fired >= 3){
-						i = MAX_PHOTONS;
-					}
-				}
+			for(fired = 0; fired < 3 && (shot = getInactivePhoton()) != NULL; fired++){
+				currentCooldown += cooldown;
+				shot->active = 1;
+				shot->x = ship.x + (fired == 0)*ship.size*sin(ship.phi) + (fired == 1)*ship.size*cos(ship.phi + (330*M_PI/180)) - (fired == 2)*ship.size*cos(ship.phi + (30*M_PI/180)) + photonSize*sin(ship.phi);
+				shot->y = ship.y + (fired == 0)*ship.size*cos(ship.phi) - (fired == 1)*ship.size*sin(ship.phi + (330*M_PI/180)) + (fired == 2)*ship.size*sin(ship.phi + (30*M_PI/180)) + photonSize*cos(ship.phi);
+
+				shot->dx = photonSpeed*sin(ship.phi);
+				shot->dy = photonSpeed*cos(ship.phi);
 			}
 		}
 	}
@@ -2763,6 +2775,7 @@ addScore(int p, double x, double y){
      * save the amount of digits that encompass the combined score to center-allign it when drawing
      */
 	int i, score;
+	Points *display;
 
 	score = scoreAL*5 + scoreAM*3 + scoreAS*2 + debrisM*10 + debrisA*100;
 	/* Tally the score and save the amount of digits of the score */
@@ -2772,16 +2785,12 @@ addScore(int p, double x, double y){
 	printf("score digits: %d\n", i);
 
 	/* Create the points object to display the amount of points the user got */
-    for(i = 0; i < MAX_POINTS; i++){
-        if(!(points[i].active)){
-            points[i].active = 1;
-            points[i].amount = p;
-            points[i].x = x;
-            points[i].y = y;
-            points[i].lifetime = 30;
-            i = MAX_POINTS;
-        }
-    }
+	display = getInactivePoints();
+	display->active = 1;
+	display->amount = p;
+	display->x = x;
+	display->y = y;
+	display->lifetime = 30;
 }
 
 void
@@ -2797,14 +2806,708 @@ nextLevel()
 		/* Respawn the asteroids for the next level to begin */
 		level++;
 		for(i = 0; i < level; i++){
-			initAsteroid(&asteroids[i], ASTEROID_LARGE);
+			initAsteroid(getInactiveAsteroid(), ASTEROID_LARGE);
 		}
 	}
 }
 
 
+/* -- Pool functions ------------------------------------------------------------------------------- */
+
+void*
+growPool(void *pool, int *capacity, size_t size, int needed)
+{
+	/*
+	 * Grow the pool of objects of the given size by doubling it's capacity until it can hold the needed amount of objects.
+	 * The new objects are zeroed so they start inactive. Returns the pool, which may have moved
+	 */
+	int newCapacity;
+
+	newCapacity = *capacity;
+	if(newCapacity < 1){
+		newCapacity = 1;
+	}
+	while(newCapacity < needed){
+		newCapacity *= 2;
+	}
+
+	if(newCapacity > *capacity){
+		pool = realloc(pool, size*newCapacity);
+		memset((char*) pool + size*(*capacity), 0, size*(newCapacity - *capacity));
+		*capacity = newCapacity;
+	}
+
+	return pool;
+}
+
+Asteroid*
+getInactiveAsteroid()
+{
+	/*
+	 * Take an inactive asteroid from it's pool, growing the asteroid pool if they are all active. The slot after the last live object is used, so the caller must activate it
+	 */
+	if(liveAsteroids == asteroidCapacity){
+		asteroids = growPool(asteroids, &asteroidCapacity, sizeof(Asteroid), asteroidCapacity + 1);
+	}
+
+	return &asteroids[liveAsteroids++];
+}
+
+Debris*
+getInactiveDebris()
+{
+	/*
+	 * Take an inactive debris from it's pool, growing the debris pool if they are all active. The slot after the last live object is used, so the caller must activate it
+	 */
+	if(liveDebris == debrisCapacity){
+		debris = growPool(debris, &debrisCapacity, sizeof(Debris), debrisCapacity + 1);
+	}
+
+	return &debris[liveDebris++];
+}
+
+Points*
+getInactivePoints()
+{
+	/*
+	 * Take an inactive points display from it's pool, growing the points pool if they are all active. The slot after the last live object is used, so the caller must activate it
+	 */
+	if(livePoints == pointsCapacity){
+		points = growPool(points, &pointsCapacity, sizeof(Points), pointsCapacity + 1);
+	}
+
+	return &points[livePoints++];
+}
+
+Photon*
+getInactivePhoton()
+{
+	/*
+	 * Take an inactive photon from the photon pool. The photon pool does not grow, so NULL is returned if every photon is active
+	 */
+	int i;
+
+	i = acquireSlot(&photonSlots);
+	if(i == -1){
+		return NULL;
+	}
+
+	return &photons[i];
+}
+
+void
+resetPools()
+{
+	/*
+	 * Deactivate every object in the pools and give all of their slots back
+	 */
+	int i;
+
+	for(i = 0; i < asteroidCapacity; i++){
+		asteroids[i].active = 0;
+	}
+	for(i = 0; i < debrisCapacity; i++){
+		debris[i].active = 0;
+	}
+	for(i = 0; i < photonCapacity; i++){
+		photons[i].active = 0;
+	}
+	for(i = 0; i < pointsCapacity; i++){
+		points[i].active = 0;
+	}
+	initFreeList(&photonSlots, photonCapacity);
+	liveAsteroids = 0;
+	liveDebris = 0;
+	dust.live = 0;
+	livePoints = 0;
+}
+
+void
+initFreeList(FreeList *list, int capacity)
+{
+	/*
+	 * Set every slot of a pool with the given capacity as inactive. The slots are stacked so the lowest slots are taken first
+	 */
+	int i;
+
+	list->slot = realloc(list->slot, sizeof(int)*capacity);
+	list->count = 0;
+	list->active = 0;
+	for(i = capacity - 1; i >= 0; i--){
+		list->slot[list->count++] = i;
+	}
+}
+
+int
+acquireSlot(FreeList *list)
+{
+	/*
+	 * Take the slot on the top of the free list and count it as active. Returns -1 if there are no inactive slots
+	 */
+	if(list->count == 0){
+		return -1;
+	}
+	list->active++;
+
+	return list->slot[--list->count];
+}
+
+void
+releaseSlot(FreeList *list, int index)
+{
+	/*
+	 * Give a slot back to the free list once it's object is deactivated
+	 */
+	list->slot[list->count++] = index;
+	list->active--;
+}
+
+void
+removeAsteroid(int index)
+{
+	/*
+	 * Remove the asteroid in the given slot by moving the last live asteroid into it, keeping the live asteroids packed
+	 */
+	liveAsteroids--;
+	asteroids[index] = asteroids[liveAsteroids];
+	asteroids[liveAsteroids].active = 0;
+}
+
+void
+removeDebris(int index)
+{
+	/*
+	 * Remove the debris in the given slot by moving the last live debris into it, keeping the live debris packed
+	 */
+	liveDebris--;
+	debris[index] = debris[liveDebris];
+	debris[liveDebris].active = 0;
+	debris[liveDebris].lifetime = 0;
+}
+
+void
+removePoints(int index)
+{
+	/*
+	 * Remove the points display in the given slot by moving the last live points display into it, keeping the live points packed
+	 */
+	livePoints--;
+	points[index] = points[livePoints];
+	points[livePoints].active = 0;
+}
+
+void
+freePools()
+{
+	/*
+	 * Release the object pools and the photon pool's free list
+	 */
+	free(photons);
+	free(asteroids);
+	free(debris);
+	freeParticleStore(&dust);
+	free(points);
+	free(photonSlots.slot);
+}
+
+
+/* -- Particle store functions --------------------------------------------------------------------- */
+
+void
+initParticleStore(ParticleStore *store)
+{
+	/*
+	 * Create the arrays of a particle store using it's set capacity. The store starts with no live particles
+	 */
+	store->live = 0;
+	store->lifetime = calloc(store->capacity, sizeof(int));
+	store->x = calloc(store->capacity, sizeof(Real));
+	store->y = calloc(store->capacity, sizeof(Real));
+	store->dx = calloc(store->capacity, sizeof(Real));
+	store->dy = calloc(store->capacity, sizeof(Real));
+}
+
+void
+growParticleStore(ParticleStore *store, int needed)
+{
+	/*
+	 * Grow every array of the particle store by doubling it's capacity until it can hold the needed amount of particles
+	 */
+	int newCapacity;
+
+	newCapacity = store->capacity;
+	if(newCapacity < 1){
+		newCapacity = 1;
+	}
+	while(newCapacity < needed){
+		newCapacity *= 2;
+	}
+
+	if(newCapacity > store->capacity){
+		store->lifetime = realloc(store->lifetime, sizeof(int)*newCapacity);
+		store->x = realloc(store->x, sizeof(Real)*newCapacity);
+		store->y = realloc(store->y, sizeof(Real)*newCapacity);
+		store->dx = realloc(store->dx, sizeof(Real)*newCapacity);
+		store->dy = realloc(store->dy, sizeof(Real)*newCapacity);
+		store->capacity = newCapacity;
+	}
+}
+
+int
+addParticle(ParticleStore *store, double x, double y, double dx, double dy, int lifetime)
+{
+	/*
+	 * Add a live particle to the end of the store, growing the store if it is full. Returns the particle's index
+	 */
+	int i;
+
+	if(store->live == store->capacity){
+		growParticleStore(store, store->capacity + 1);
+	}
+
+	i = store->live++;
+	store->x[i] = x;
+	store->y[i] = y;
+	store->dx[i] = dx;
+	store->dy[i] = dy;
+	store->lifetime[i] = lifetime;
+
+	return i;
+}
+
+void
+integrateParticles(ParticleStore *store, double drag)
+{
+	/*
+	 * Move every live particle by it's velocity, then slow the velocity by the drag and lower the lifetime.
+	 * Each value is updated in it's own loop with no branches or aliasing so the compiler can vectorize them.
+	 * Without vector instructions these are ordinary scalar loops with the same results
+	 */
+	int i, count;
+	Real *restrict x = store->x;
+	Real *restrict y = store->y;
+	Real *restrict dx = store->dx;
+	Real *restrict dy = store->dy;
+	int *restrict lifetime = store->lifetime;
+	Real scale = drag;
+
+	count = store->live;
+	for(i = 0; i < count; i++){
+		x[i] += dx[i];
+	}
+	for(i = 0; i < count; i++){
+		y[i] += dy[i];
+	}
+	for(i = 0; i < count; i++){
+		dx[i] *= scale;
+	}
+	for(i = 0; i < count; i++){
+		dy[i] *= scale;
+	}
+	for(i = 0; i < count; i++){
+		lifetime[i]--;
+	}
+}
+
+void
+removeExpiredParticles(ParticleStore *store)
+{
+	/*
+	 * Remove the particles whose lifetime has run out by moving the last live particle into their slot.
+	 * The slot is checked again since the moved particle may have expired as well
+	 */
+	int i, last;
+
+	for(i = 0; i < store->live; i++){
+		if(store->lifetime[i] <= 0){
+			last = --store->live;
+			store->x[i] = store->x[last];
+			store->y[i] = store->y[last];
+			store->dx[i] = store->dx[last];
+			store->dy[i] = store->dy[last];
+			store->lifetime[i] = store->lifetime[last];
+			i--;
+		}
+	}
+}
+
+void
+freeParticleStore(ParticleStore *store)
+{
+	/*
+	 * Release the arrays of a particle store
+	 */
+	free(store->lifetime);
+	free(store->x);
+	free(store->y);
+	free(store->dx);
+	free(store->dy);
+}
+
+
+/* -- Collision grid functions ------------------------------------------------------------------------ */
+
+void
+resetCollisionGrid(CollisionGrid *grid)
+{
+	/*
+	 * Empty the grid and size it to cover the current playfield. Asteroids wrap once they are GRID_MARGIN past an edge,
+	 * so the grid extends that far past every edge. The top edge uses the larger of xMax and yMax as that is where asteroids wrap vertically
+	 */
+	int cells;
+
+	grid->left = -GRID_MARGIN;
+	grid->bottom = -GRID_MARGIN;
+	grid->columns = 1 + (int) ((xMax + 2*GRID_MARGIN)/GRID_CELL_SIZE);
+	grid->rows = 1 + (int) ((fmax(xMax, yMax) + 2*GRID_MARGIN)/GRID_CELL_SIZE);
+
+	cells = grid->columns*grid->rows;
+	if(cells + 1 > grid->cellCapacity){
+		grid->cellCapacity = cells + 1;
+		grid->cellStart = realloc(grid->cellStart, sizeof(int)*grid->cellCapacity);
+	}
+	grid->entryCount = 0;
+}
+
+void
+insertCollisionGrid(CollisionGrid *grid, int index, double x, double y, double radius)
+{
+	/*
+	 * Add the object at the given index to every cell that it's bounding circle overlaps. Objects outside the grid are placed
+	 * in the closest cells on the grid's edge. Objects need to be inserted in the order of their index
+	 */
+	int c, r, c0, c1, r0, r1, i;
+
+	c0 = getCollisionGridCell(grid->columns, (x - radius - grid->left)/GRID_CELL_SIZE);
+	c1 = getCollisionGridCell(grid->columns, (x + radius - grid->left)/GRID_CELL_SIZE);
+	r0 = getCollisionGridCell(grid->rows, (y - radius - grid->bottom)/GRID_CELL_SIZE);
+	r1 = getCollisionGridCell(grid->rows, (y + radius - grid->bottom)/GRID_CELL_SIZE);
+
+	/* Make room for the new entries and for the object's index to be stamped when querying */
+	if(grid->entryCount + (c1 - c0 + 1)*(r1 - r0 + 1) > grid->entryCapacity){
+		grid->entryCapacity = 2*(grid->entryCount + (c1 - c0 + 1)*(r1 - r0 + 1));
+		grid->entryCell = realloc(grid->entryCell, sizeof(int)*grid->entryCapacity);
+		grid->entryIndex = realloc(grid->entryIndex, sizeof(int)*grid->entryCapacity);
+		grid->index = realloc(grid->index, sizeof(int)*grid->entryCapacity);
+	}
+	if(index >= grid->objectCapacity){
+		grid->stamp = realloc(grid->stamp, sizeof(int)*(index + 1)*2);
+		grid->result = realloc(grid->result, sizeof(int)*(index + 1)*2);
+		for(i = grid->objectCapacity; i < (index + 1)*2; i++){
+			grid->stamp[i] = 0;
+		}
+		grid->objectCapacity = (index + 1)*2;
+	}
+
+	for(r = r0; r <= r1; r++){
+		for(c = c0; c <= c1; c++){
+			grid->entryCell[grid->entryCount] = r*grid->columns + c;
+			grid->entryIndex[grid->entryCount] = index;
+			grid->entryCount++;
+		}
+	}
+}
+
+void
+buildCollisionGrid(CollisionGrid *grid)
+{
+	/*
+	 * Sort the inserted entries by their cell so each cell's objects are found in index[cellStart[cell]] to index[cellStart[cell + 1]].
+	 * The entries are placed from last to first, so each cell keeps it's objects in the order they were inserted
+	 */
+	int i, cells;
+
+	cells = grid->columns*grid->rows;
+	for(i = 0; i <= cells; i++){
+		grid->cellStart[i] = 0;
+	}
+
+	/* Count the entries of each cell and turn the counts into the position after each cell's last entry */
+	for(i = 0; i < grid->entryCount; i++){
+		grid->cellStart[grid->entryCell[i]]++;
+	}
+	for(i = 1; i <= cells; i++){
+		grid->cellStart[i] += grid->cellStart[i - 1];
+	}
+
+	/* Place the entries, leaving each cellStart at the position of it's cell's first entry */
+	for(i = grid->entryCount - 1; i >= 0; i--){
+		grid->index[--grid->cellStart[grid->entryCell[i]]] = grid->entryIndex[i];
+	}
+}
+
+int
+queryCollisionGrid(CollisionGrid *grid, double x, double y, double radius)
+{
+	/*
+	 * Find every object in the cells that the given bounding circle overlaps. The indices are saved in the grid's result array in increasing
+	 * order, with each object only found once. Returns how many objects were found
+	 */
+	int c, r, c0, c1, r0, r1, i, count, index;
+
+	c0 = getCollisionGridCell(grid->columns, (x - radius - grid->left)/GRID_CELL_SIZE);
+	c1 = getCollisionGridCell(grid->columns, (x + radius - grid->left)/GRID_CELL_SIZE);
+	r0 = getCollisionGridCell(grid->rows, (y - radius - grid->bottom)/GRID_CELL_SIZE);
+	r1 = getCollisionGridCell(grid->rows, (y + radius - grid->bottom)/GRID_CELL_SIZE);
+
+	/* Use a new stamp to mark which objects have already been found by this query */
+	grid->currentStamp++;
+	count = 0;
+	for(r = r0; r <= r1; r++){
+		for(c = c0; c <= c1; c++){
+			for(i = grid->cellStart[r*grid->columns + c]; i < grid->cellStart[r*grid->columns + c + 1]; i++){
+				index = grid->index[i];
+				if(grid->stamp[index] != grid->currentStamp){
+					grid->stamp[index] = grid->currentStamp;
+					grid->result[count++] = index;
+				}
+			}
+		}
+	}
+
+	/* Sort the found objects so they are checked in the same order as the object arrays. Only a few objects are ever found */
+	for(i = 1; i < count; i++){
+		index = grid->result[i];
+		for(c = i; c > 0 && grid->result[c - 1] > index; c--){
+			grid->result[c] = grid->result[c - 1];
+		}
+		grid->result[c] = index;
+	}
+
+	return count;
+}
+
+int
+getCollisionGridCell(int cells, double position)
+{
+	/*
+	 * Return the cell along one axis of the grid that the position is in, clamped to the grid's edges
+	 */
+	if(position < 0){
+		return 0;
+	}else if(position >= cells){
+		return cells - 1;
+	}
+	return (int) position;
+}
+
+void
+freeCollisionGrid()
+{
+	/*
+	 * Release the memory used by the collision grid
+	 */
+	free(collisionGrid.cellStart);
+	free(collisionGrid.index);
+	free(collisionGrid.entryCell);
+	free(collisionGrid.entryIndex);
+	free(collisionGrid.stamp);
+	free(collisionGrid.result);
+}
+
+
+/* -- Batch rendering functions --------------------------------------------------------------------- */
+
+void
+batchMode(GLenum mode)
+{
+	/*
+	 * Set the primitive that the next vertices make. The vertices already in the batch are drawn first if they use another primitive
+	 */
+	if(batch.mode != mode){
+		flushBatch();
+		batch.mode = mode;
+	}
+}
+
+void
+batchVertex(double x, double y, double r, double g, double b)
+{
+	/*
+	 * Add a vertex to the batch, doubling the batch's size if it is full
+	 */
+	if(batch.count == batch.capacity){
+		batch.capacity = batch.capacity > 0 ? batch.capacity*2 : 1024;
+		batch.vertex = realloc(batch.vertex, sizeof(GLfloat)*2*batch.capacity);
+		batch.color = realloc(batch.color, sizeof(GLfloat)*3*batch.capacity);
+	}
+
+	batch.vertex[batch.count*2 + 0] = x;
+	batch.vertex[batch.count*2 + 1] = y;
+	batch.color[batch.count*3 + 0] = r;
+	batch.color[batch.count*3 + 1] = g;
+	batch.color[batch.count*3 + 2] = b;
+	batch.count++;
+}
+
+void
+batchFan(double x, double y, Coords *vertex, int count, double scale, double r, double g, double b)
+{
+	/*
+	 * Add a filled polygon as triangles going from the center (x, y) to each of it's edges. The polygon's vertices are moved
+	 * towards the center by the scale. The polygon only needs to be visible from it's center, so asteroids can be concave
+	 */
+	int i, j;
+
+	batchMode(GL_TRIANGLES);
+	for(i = 0; i < count; i++){
+		j = (i + 1) % count;
+		batchVertex(x, y, r, g, b);
+		batchVertex(x + scale*(vertex[i].x - x), y + scale*(vertex[i].y - y), r, g, b);
+		batchVertex(x + scale*(vertex[j].x - x), y + scale*(vertex[j].y - y), r, g, b);
+	}
+}
+
+void
+flushBatch()
+{
+	/*
+	 * Draw every vertex in the batch with a single call and empty the batch
+	 */
+	if(batch.count == 0){
+		return;
+	}
+
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, batch.vertex);
+	glColorPointer(3, GL_FLOAT, 0, batch.color);
+	glDrawArrays(batch.mode, 0, batch.count);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	batch.count = 0;
+}
+
+void
+freeBatch()
+{
+	/*
+	 * Release the batch's vertex and color arrays
+	 */
+	free(batch.vertex);
+	free(batch.color);
+}
+
+
+/* -- Replay checking functions --------------------------------------------------------------------- */
+
+void
+printChecksum(int tick)
+{
+	/*
+	 * Print the state of the asteroids game at the given tick. The counts and the hash must match exactly between two runs
+	 * of the same build and seed. The ship's position and the sum of the asteroid positions are printed on their own so
+	 * builds of a different precision (-DASTEROIDS_FLOAT) can be compared within a tolerance, as done by checkReplay.sh.
+	 * The hash rounds each value to 1/1024 of a unit, which keeps it the same for the same build on any machine
+	 */
+	int i;
+	unsigned int hash;
+	double asteroidSum;
+
+	hash = 2166136261u;
+	hashValue(&hash, ship.x);
+	hashValue(&hash, ship.y);
+	hashValue(&hash, ship.phi);
+	hashValue(&hash, ship.dx);
+	hashValue(&hash, ship.dy);
+
+	asteroidSum = 0;
+	for(i = 0; i < liveAsteroids; i++){
+		hashValue(&hash, asteroids[i].x);
+		hashValue(&hash, asteroids[i].y);
+		hashValue(&hash, asteroids[i].phi);
+		asteroidSum += asteroids[i].x + asteroids[i].y;
+	}
+	for(i = 0; i < photonCapacity; i++){
+		if(photons[i].active){
+			hashValue(&hash, photons[i].x);
+			hashValue(&hash, photons[i].y);
+		}
+	}
+	for(i = 0; i < liveDebris; i++){
+		hashValue(&hash, debris[i].x);
+		hashValue(&hash, debris[i].y);
+	}
+
+	printf("checksum tick=%d asteroids=%d photons=%d debris=%d dust=%d metal=%d alloy=%d ship=%.4f,%.4f asteroidSum=%.4f hash=%08x\n",
+			tick, liveAsteroids, photonSlots.active, liveDebris, dust.live, metalCount, alloyCount, (double) ship.x, (double) ship.y,
+			asteroidSum, hash);
+}
+
+void
+hashValue(unsigned int *hash, double value)
+{
+	/*
+	 * Add a value rounded to 1/1024 of a unit to the FNV-1a hash, one byte at a time
+	 */
+	long long rounded;
+	int i;
+
+	rounded = (long long) floor(value*1024);
+	for(i = 0; i < 8; i++){
+		*hash ^= (rounded >> (i*8)) & 0xff;
+		*hash *= 16777619u;
+	}
+}
+
+
 /* -- helper function ------------------------------------------------------- */
 
+int
+polygonCollision(Coords *a, int aCount, Coords *b, int bCount)
+{
+	/*
+	 * Test every edge of polygon a against every edge of polygon b. The polygons can be convex or concave, and edge k of a
+	 * polygon goes from it's vertex k to vertex k+1. Returns a mask with the bit of each edge of a that crosses an edge of b
+	 */
+	int j, k, hitEdges;
+	double left, right, bottom, top;
+
+	hitEdges = 0;
+	for(k = 0; k < aCount; k++){
+		/* Skip the edges of b that are completely to one side of this edge's bounding box */
+		left = fmin(a[k].x, a[(k + 1) % aCount].x);
+		right = fmax(a[k].x, a[(k + 1) % aCount].x);
+		bottom = fmin(a[k].y, a[(k + 1) % aCount].y);
+		top = fmax(a[k].y, a[(k + 1) % aCount].y);
+		for(j = 0; j < bCount && !(hitEdges & (1 << k)); j++){
+			if(fmax(b[j].x, b[(j + 1) % bCount].x) < left || fmin(b[j].x, b[(j + 1) % bCount].x) > right ||
+					fmax(b[j].y, b[(j + 1) % bCount].y) < bottom || fmin(b[j].y, b[(j + 1) % bCount].y) > top){
+				continue;
+			}
+			if(lineCollision(a[k].x, a[k].y, a[(k + 1) % aCount].x, a[(k + 1) % aCount].y,
+					b[j].x, b[j].y, b[(j + 1) % bCount].x, b[(j + 1) % bCount].y)){
+				hitEdges |= 1 << k;
+			}
+		}
+	}
+
+	return hitEdges;
+}
+
+double
+segmentDistance(double px, double py, double x1, double y1, double x2, double y2)
+{
+	/*
+	 * Return the squared distance between the point (px, py) and the closest point on the line segment (x1, y1) (x2, y2)
+	 */
+	double lambda, length;
+
+	length = pow(x2 - x1, 2) + pow(y2 - y1, 2);
+	lambda = 0;
+	if(length > 0){
+		lambda = ((px - x1)*(x2 - x1) + (py - y1)*(y2 - y1)) / length;
+		if(lambda < 0){
+			lambda = 0;
+		}else if(lambda > 1){
+			lambda = 1;
+		}
+	}
+
+	return pow(x1 + lambda*(x2 - x1) - px, 2) + pow(y1 + lambda*(y2 - y1) - py, 2);
+}
+
 int lineCollision(double Ax, double Ay, double Bx, double By, double Cx, double Cy, double Dx, double Dy)
 {
 	/*
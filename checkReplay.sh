@@ -0,0 +1,66 @@
+#!/bin/sh
+#
+# Check that the asteroids game replays the same way from a seed, using the checksums printed by -checksum.
+#
+# 1. The double and float (-DASTEROIDS_FLOAT) builds must each print the exact same checksums when a seed is run twice.
+# 2. The float build must follow the double build: every object count must match and the ship's position and the sum
+#    of the asteroid positions must stay within TOLERANCE units for the first COMPARE_TICKS ticks. The error of storing
+#    the positions as floats grows by about 0.001 units every 100 ticks, so the tolerance is reached after about 700 ticks.
+#    After that a collision can land on a different tick and the two builds play out differently.
+#
+# Usage: ./checkReplay.sh [seeds]
+
+SEEDS=${1:-"1 2 3 4 5 6 7 8 9 10"}
+REPLAY_TICKS=20000
+COMPARE_TICKS=600
+INTERVAL=100
+TOLERANCE=0.01
+
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+
+gcc -o "$DIR/double" simple.c -lglut -lGLU -lGL -lm || exit 1
+gcc -DASTEROIDS_FLOAT -o "$DIR/float" simple.c -lglut -lGLU -lGL -lm || exit 1
+
+failed=0
+for seed in $SEEDS; do
+	# The game writes it's savefile into the working directory
+	for build in double float; do
+		(cd "$DIR" && ./$build -headless $REPLAY_TICKS -seed $seed -checksum $INTERVAL | grep checksum > $build.1)
+		(cd "$DIR" && ./$build -headless $REPLAY_TICKS -seed $seed -checksum $INTERVAL | grep checksum > $build.2)
+		if ! cmp -s "$DIR/$build.1" "$DIR/$build.2"; then
+			echo "seed $seed: the $build build did not replay the same way"
+			failed=1
+		fi
+	done
+
+	head -n $((COMPARE_TICKS/INTERVAL)) "$DIR/double.1" > "$DIR/double.compare"
+	head -n $((COMPARE_TICKS/INTERVAL)) "$DIR/float.1" > "$DIR/float.compare"
+	if ! paste -d' ' "$DIR/double.compare" "$DIR/float.compare" | awk -v seed=$seed -v tolerance=$TOLERANCE '
+		function abs(v){ return v < 0 ? -v : v }
+		{
+			# Fields 2 to 8 are the tick and the counts of the double build, 13 to 19 of the float build
+			for(i = 2; i <= 8; i++){
+				if($i != $(i + 11)){
+					print "seed " seed ": " $i " (double) and " $(i + 11) " (float) differ at " $2
+					exit 1
+				}
+			}
+			split($9, a, "[=,]"); split($20, b, "[=,]");
+			split($10, c, "="); split($21, d, "=");
+			error = abs(a[2] - b[2]);
+			if(abs(a[3] - b[3]) > error) error = abs(a[3] - b[3]);
+			if(abs(c[2] - d[2]) > error) error = abs(c[2] - d[2]);
+			if(error > tolerance){
+				print "seed " seed ": the float build is " error " units from the double build at " $2
+				exit 1
+			}
+		}'; then
+		failed=1
+	fi
+done
+
+if [ $failed -eq 0 ]; then
+	echo "replay check passed for seeds $SEEDS"
+fi
+exit $failed
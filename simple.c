@@ -16,6 +16,10 @@
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <GL/glut.h>
 #include "simple.h"
 #include "textures.c"
@@ -23,6 +27,8 @@
 #include "systemViewer.c"
 #include "menus.c"
 
+/* Length of a single game tick in milliseconds. Every update function assumes this fixed timestep */
+#define TICK_LENGTH 33
 
 /* -- type definitions ------------------------------------------------------ */
 
@@ -46,14 +52,23 @@ static void optionSelect();
 
 
 /* Functions that operate with outside files such as the savefile */
-static void loadSavefile();
+static int loadSavefile();
+static int importTextSavefile(char* textName);
+
+/* Read a pool capacity given on the command line */
+static void setCapacity(int* capacity, char* value);
+static char* optionValue(char *argv[], int* i);
 
 /* These functions are used on every timer tick. They are
  * used to update, advance and collision check all the different objects in the game */
+static void simulationTick();
+static void stepSimulation(int ticks);
 
 
 /* Useful functions that return values pertaining their mathematical problem */
 static double myRandom(double min, double max);
+static double effectRandom(double min, double max);
+static double universeRandom(double min, double max);
 
 
 /* -- global variables ------------------------------------------------------ */
@@ -70,14 +85,81 @@ int maxOption;
 /* The size of the game's window */
 double xMax, yMax, h, w;
 
+/* Set when the game is run without a window (-headless). No GL or GLUT calls are made while this is set */
+int headless = 0;
+
+/* A savefile in the old text format given with -import. It is converted into the binary savefile and loaded in init() */
+char* importName = NULL;
+
 
 /* -- main ------------------------------------------------------------------ */
 
 int
 main(int argc, char *argv[])
 {
+	int i, ticks, checksumInterval;
+	clock_t start;
+	double seconds;
+
 	atexit(endProgram);
-    srand((unsigned int) time(NULL));
+    randomSeed = (unsigned int) time(NULL);
+    ticks = 0;
+    checksumInterval = 0;
+
+    /* "-headless <ticks>" runs the asteroids game for the given amount of ticks without opening a window.
+     * "-import <file>" converts a text savefile into the binary savefile and starts from it.
+     * "-seed <number>" starts the random streams from the given seed instead of the time, to replay a game.
+     * "-checksum <interval>" prints a checksum of the game's state every interval ticks of a headless run.
+     * "-asteroids", "-photons", "-debris", "-dust" and "-points" followed by a count set the starting capacity of that object's pool */
+    for(i = 1; i < argc; i++){
+    	if(strcmp(argv[i], "-headless") == 0){
+    		headless = 1;
+    		ticks = atoi(optionValue(argv, &i));
+    	}else if(strcmp(argv[i], "-import") == 0){
+    		importName = optionValue(argv, &i);
+    	}else if(strcmp(argv[i], "-seed") == 0){
+    		randomSeed = (unsigned int) strtoul(optionValue(argv, &i), NULL, 10);
+    	}else if(strcmp(argv[i], "-checksum") == 0){
+    		checksumInterval = atoi(optionValue(argv, &i));
+    	}else if(strcmp(argv[i], "-asteroids") == 0){
+    		setCapacity(&asteroidCapacity, optionValue(argv, &i));
+    	}else if(strcmp(argv[i], "-photons") == 0){
+    		setCapacity(&photonCapacity, optionValue(argv, &i));
+    	}else if(strcmp(argv[i], "-debris") == 0){
+    		setCapacity(&debrisCapacity, optionValue(argv, &i));
+    	}else if(strcmp(argv[i], "-dust") == 0){
+    		setCapacity(&dust.capacity, optionValue(argv, &i));
+    	}else if(strcmp(argv[i], "-points") == 0){
+    		setCapacity(&pointsCapacity, optionValue(argv, &i));
+    	}else{
+    		printf("ERROR: unknown option %s\n", argv[i]);
+    		exit(1);
+    	}
+    }
+    seedRandom(randomSeed);
+
+    if(headless){
+    	w = 500;
+    	h = 500;
+
+    	init();
+    	changeState(STATE_ASTEROIDS);
+
+    	start = clock();
+    	if(checksumInterval > 0){
+    		for(i = checksumInterval; i <= ticks; i += checksumInterval){
+    			stepSimulation(checksumInterval);
+    			printChecksum(i);
+    		}
+    		stepSimulation(ticks % checksumInterval);
+    	}else{
+    		stepSimulation(ticks);
+    	}
+    	seconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+    	printf("ran %d ticks in %f seconds (%f ticks per second) with seed %u\n", ticks, seconds, seconds > 0 ? ticks/seconds : 0, randomSeed);
+
+    	return 0;
+    }
 
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE|GLUT_RGB);
@@ -89,7 +171,7 @@ main(int argc, char *argv[])
     glutSpecialFunc(keyPress);
     glutSpecialUpFunc(keyRelease);
     glutReshapeFunc(myReshape);
-    glutTimerFunc(33, myTimer, 0);
+    glutTimerFunc(TICK_LENGTH, myTimer, 0);
     glClearColor(0.0, 0.0, 0.0, 1.0);
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     glDisable(GL_DEPTH_TEST);
@@ -110,7 +192,7 @@ endProgram()
 	/*
 	 * Free whatever memory has been allocated and save the currentSystem
 	 */
-	int i, ii, iii;
+	int i;
 
 	printf("exiting...\n");
 	saveSystem();
@@ -119,7 +201,6 @@ endProgram()
 	printf("start freeing memory\n");
 	free(camera);
 	free(systemDistanceArray);
-	free(BGStars);
 
 	//Free the systemArray
 	if(systemArray != NULL){
@@ -143,17 +224,18 @@ endProgram()
 
 	printf("started freeing currentSystem\n");
 
-	//Free the current systems planet array along with it's surface arrays
-	for(i = 0; i < currentSystem->planetCount; i++){
-		for(ii = 0; ii < currentSystem->planet[i]->surfaceRows; ii++){
-			for(iii = 0; iii < currentSystem->planet[i]->surfaceColumns; iii++){
-				free(currentSystem->planet[i]->surface[ii][iii]);
-			}
-		}
-		free(currentSystem->planet[i]);
-	}
-	free(currentSystem->planet);
-	free(currentSystem->star);
+	//Free everything allocated for the current system at once. The star and surfaces belong to the savefile
+	free(systemArena.memory);
+	free(launchList);
+	free(skyboxVertex);
+	free(nearbyIndex);
+	freeTextures();
+	freeCollisionGrid();
+	freePools();
+	freeBatch();
+
+	//Write back and release the savefile
+	unmapSavefile();
 	printf("done freeing memory");
 }
 
@@ -196,10 +278,10 @@ myDisplay()
 			if (backgroundStars[i].active)
 				drawBackground(&backgroundStars[i]);
 
-		for (i=0; i<MAX_ASTEROIDS; i++)
-			if (asteroids[i].active)
-				drawAsteroid(&asteroids[i]);
+		for (i=0; i<liveAsteroids; i++)
+			drawAsteroid(&asteroids[i]);
 
+		flushBatch();
 		drawTitle();
 
     }else if(state == STATE_ASTEROIDS){
@@ -207,25 +289,21 @@ myDisplay()
 			if (backgroundStars[i].active)
 				drawBackground(&backgroundStars[i]);
 
-		for (i=0; i<MAX_PHOTONS; i++)
+		for (i=0; i<photonCapacity; i++)
 			if (photons[i].active)
 				drawPhoton(&photons[i]);
 
-		for (i=0; i<MAX_ASTEROIDS; i++)
-			if (asteroids[i].active)
-				drawAsteroid(&asteroids[i]);
+		for (i=0; i<liveAsteroids; i++)
+			drawAsteroid(&asteroids[i]);
 
-		for (i=0; i<MAX_DEBRIS; i++)
-			if (debris[i].active)
-				drawDebris(&debris[i]);
+		for (i=0; i<liveDebris; i++)
+			drawDebris(&debris[i]);
 
-		for (i=0; i<MAX_DUST; i++)
-			if (dust[i].active)
-				drawDust(&dust[i]);
+		drawDust();
+		flushBatch();
 
-		for (i=0; i<MAX_POINTS; i++)
-			if(points[i].active)
-				drawPoints(&points[i]);
+		for (i=0; i<livePoints; i++)
+			drawPoints(&points[i]);
 
 		drawUpgrade();
 		drawScore();
@@ -238,25 +316,21 @@ myDisplay()
 			if (backgroundStars[i].active)
 				drawBackground(&backgroundStars[i]);
 
-		for (i=0; i<MAX_PHOTONS; i++)
+		for (i=0; i<photonCapacity; i++)
 			if (photons[i].active)
 				drawPhoton(&photons[i]);
 
-		for (i=0; i<MAX_ASTEROIDS; i++)
-			if (asteroids[i].active)
-				drawAsteroid(&asteroids[i]);
+		for (i=0; i<liveAsteroids; i++)
+			drawAsteroid(&asteroids[i]);
 
-		for (i=0; i<MAX_DEBRIS; i++)
-			if (debris[i].active)
-				drawDebris(&debris[i]);
+		for (i=0; i<liveDebris; i++)
+			drawDebris(&debris[i]);
 
-		for (i=0; i<MAX_DUST; i++)
-			if (dust[i].active)
-				drawDust(&dust[i]);
+		drawDust();
+		flushBatch();
 
-		for (i=0; i<MAX_POINTS; i++)
-			if(points[i].active)
-				drawPoints(&points[i]);
+		for (i=0; i<livePoints; i++)
+			drawPoints(&points[i]);
 
 		drawUpgradeText();
 		drawShip();
@@ -265,12 +339,15 @@ myDisplay()
         for (i=0; i<pow(MAX_STARS, 2); i++)
 			if (backgroundStars[i].active)
 				drawBackground(&backgroundStars[i]);
+        flushBatch();
 
         drawShipSelect();
     }else if(state == STATE_SYSTEM){
     	drawSystem();
     }
 
+    /* Draw anything left in the batch, then flush once for the whole frame */
+    flushBatch();
     glFlush();
     glutSwapBuffers();
 }
@@ -282,82 +359,13 @@ myTimer(int value)
      * timer callback function runs a list of commands at every in-game tick. In asteroids, the background stars and the ship's red tinge
      * will oscillate periodically, the score and the display will update, certain values will be incremented/decremented,
      * move all objects using their speed and rotation, check for collisions, the timer function will set itself again, etc.
-     * This is the main function and for every game state, different functions are run on every tick.
+     * The game logic itself is run by simulationTick(), this only connects it to GLUT.
 	 */
-
-	/* run different sets of instructions depending on the game state */
-	if(state == STATE_TITLE){
-		/*Increment the oscillation variable and the background */
-		updateBackground();
-		incrementOscillation();
-
-		advanceAsteroid();
-	}else if(state == STATE_ASTEROIDS){
-		/*Increment the oscillation variable and the background */
-		updateBackground();
-		incrementOscillation();
-
-		/* use a set of functions to advance the objects' positions */
-		advanceDust();
-		advanceDebris();
-		advanceShip();
-		advancePhoton();
-		advanceAsteroid();
-		advancePoints();
-
-		/* test for and handle collisions */
-		collisionAsteroidPhoton();
-		collisionAsteroidShip();
-		collisionDebrisShip();
-
-		/* Lower the cooldown variable */
-		lowerCooldown();
-
-		/* Lower the "xDmg" ship variables that give the ship invincibility once hit */
-		updateDamage();
-
-		/* Update the text to decrement it's lifetime or to deactivate */
-		updateUpgradeText();
-
-		/* Update the next level text to display the current level/end level sequence */
-		updateLevelText();
-
-		/* Update the respawn timer used when the ship gets destroyed */
-		updateRespawn();
-
-	}else if(state == STATE_HELP){
-		/*Increment the oscillation variable and the background */
-		updateBackground();
-		incrementOscillation();
-
-		/* Enable certain updates to be done to allow the help screen to be helpful */
-		advanceAsteroid();
-		advanceDebris();
-		advanceDust();
-		advanceShip();
-		advancePoints();
-		updateUpgradeText();
-		collisionDebrisShip();
-	}else if(state  == STATE_SHIPSELECT){
-		/*Increment the oscillation variable and the background */
-		updateBackground();
-		incrementOscillation();
-
-		lowerCooldown();
-	}else if(state == STATE_SYSTEM){
-		advanceSystem();
-		if(windowState == 0){
-			/* Don't update the camera's position if there is a communications window up */
-			advanceCamera();
-		}
-		updateWindow();
-		updateShipPath();
-		updateSatellitePath(0);
-	}
+	stepSimulation(1);
 
 	/* Update the display frame and restart a timer for the timer function */
 	glutPostRedisplay();
-    glutTimerFunc(33, myTimer, value);		/* 30 frames per second */
+    glutTimerFunc(TICK_LENGTH, myTimer, value);		/* 30 frames per second */
 }
 
 void
@@ -674,11 +682,16 @@ myReshape(int newW, int newH)
     xMax = 100.0*w/h;
     yMax = 100.0;
 
-    glViewport(0, 0, w, h);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glOrtho(0.0, xMax, 0.0, yMax, -1.0, 1.0);
-    glMatrixMode(GL_MODELVIEW);
+    if(!headless){
+    	glViewport(0, 0, w, h);
+    	glMatrixMode(GL_PROJECTION);
+    	glLoadIdentity();
+    	glOrtho(0.0, xMax, 0.0, yMax, -1.0, 1.0);
+    	glMatrixMode(GL_MODELVIEW);
+
+    	/* Regenerate the static noise textures for the new window size */
+    	resizeStaticTextures(w, h);
+    }
 
     /* Regenerate the starry background when the window is resized */
     initBackground(xMax, yMax);
@@ -690,16 +703,31 @@ myReshape(int newW, int newH)
 void
 init()
 {
-	glClearDepth(1.0);
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_TEXTURE_2D);
-	glEnable(GL_BLEND);
-	glDepthFunc(GL_LEQUAL);
-	glShadeModel(GL_SMOOTH);
-	glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glClearColor(0.0, 0.0, 0.0, 0.0);
-	glDepthFunc(GL_LEQUAL);
+	/* Set values pertinent to rendering and lighting, which are skipped when there is no window */
+	GLfloat ambient[] = { 1.0, 1.0, 1.0, 1.0 };
+	GLfloat diffuse[] = { 1.0, 1.0, 1.0, 1.0 };
+	GLfloat specular[] = { 1.0, 1.0, 1.0, 1.0 };
+	GLfloat position[] = { 0, 0, 0, 1.0 };
+	GLfloat shininess[] = {50.0};
+	if(!headless){
+		glClearDepth(1.0);
+		glEnable(GL_DEPTH_TEST);
+		glEnable(GL_TEXTURE_2D);
+		glEnable(GL_BLEND);
+		glDepthFunc(GL_LEQUAL);
+		glShadeModel(GL_SMOOTH);
+		glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glClearColor(0.0, 0.0, 0.0, 0.0);
+		glDepthFunc(GL_LEQUAL);
+
+		glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
+		glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuse);
+		glLightfv(GL_LIGHT0, GL_SPECULAR, specular);
+		glLightfv(GL_LIGHT0, GL_POSITION, position);
+		glLightfv(GL_LIGHT0, GL_SHININESS, shininess);
+		glEnable(GL_LIGHT0);
+	}
 
 	/*
 	 * Set parameters relevent to overwall program running such as lighting, window size, etc
@@ -708,19 +736,6 @@ init()
     xMax = 500;
     yMax = 500;
 
-	/* Set values pertinent to lighting */
-	GLfloat ambient[] = { 1.0, 1.0, 1.0, 1.0 };
-	GLfloat diffuse[] = { 1.0, 1.0, 1.0, 1.0 };
-	GLfloat specular[] = { 1.0, 1.0, 1.0, 1.0 };
-	GLfloat position[] = { 0, 0, 0, 1.0 };
-	GLfloat shininess[] = {50.0};
-	glLightfv(GL_LIGHT0, GL_AMBIENT, ambient);
-	glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuse);
-	glLightfv(GL_LIGHT0, GL_SPECULAR, specular);
-	glLightfv(GL_LIGHT0, GL_POSITION, position);
-	glLightfv(GL_LIGHT0, GL_SHININESS, shininess);
-	glEnable(GL_LIGHT0);
-
 	/* Initilize a new user's stats for the Player  */
 	player.cooldown = 0;
 	player.currentCooldown = 0;
@@ -752,10 +767,20 @@ init()
 
 	/* Load a previously created save file */
 	/* If loading a previous savefile, start loading populating systemArray */
-//	loadSavefile();
-
-	/* Generate new random system data */
-	randomSystem();
+	if(importName != NULL){
+		/* A failed import leaves the savefile as it was, so fall back to it before creating new systems */
+		if(!importTextSavefile(importName)){
+			printf("ERROR IMPORTING %s, LOADING %s INSTEAD\n", importName, SAVEFILE_NAME);
+		}
+		if(!loadSavefile()){
+			/* There are no systems to start in without the savefile */
+			printf("ERROR LOADING %s, STARTING WITH NEW RANDOM SYSTEMS\n", SAVEFILE_NAME);
+			randomSystem();
+		}
+	}else{
+		/* Generate new random system data */
+		randomSystem();
+	}
 
 	/* Populate the backgroud stars array after the systemArray has been created */
 	calculateBackgroundStars();
@@ -785,6 +810,10 @@ changeState(int s)
 	 * States that are in 3D:
 	 * STATE_SYSTEM
 	 */
+	Asteroid *a;
+	Photon *shot;
+	Debris *piece;
+
 	//Disable backface culling whenever 3D rendering is done
 	//glDisable(GL_CULL_FACE);
 
@@ -792,13 +821,20 @@ changeState(int s)
 		clear();
 		if(s == STATE_TITLE || s == STATE_ASTEROIDS || s == STATE_HELP || s == STATE_SHIPSELECT){
 			/* 2D rendering */
-			glDisable(GL_CULL_FACE);
-			glDisable(GL_LIGHTING);
+			if(!headless){
+				glDisable(GL_CULL_FACE);
+				glDisable(GL_LIGHTING);
+				glDisable(GL_RESCALE_NORMAL);
+			}
 			myReshape(w, h);
 		}else if(s == STATE_SYSTEM){
 			/* 3D rendering */
-			glEnable(GL_LIGHTING);
-			glEnable(GL_CULL_FACE);
+			if(!headless){
+				glEnable(GL_LIGHTING);
+				glEnable(GL_CULL_FACE);
+				/* The stars and planets are scaled unit spheres, so their normals need to be scaled back */
+				glEnable(GL_RESCALE_NORMAL);
+			}
 		}else{
 			/* State has not been given a proper dimension rendering */
 			printf("!!!State has not been given a proper dimension rendering!!!\n");
@@ -806,15 +842,18 @@ changeState(int s)
 		/* Set values dependent on the new state */
 		if(s == STATE_TITLE){
 			/* Spawn a few asteroids to float around the title screen */
-			initAsteroid(&asteroids[0], ASTEROID_LARGE);
-			asteroids[0].x = myRandom(0.0, xMax);
-			asteroids[0].y = myRandom(0.0, yMax);
-			initAsteroid(&asteroids[1], ASTEROID_MEDIUM);
-			asteroids[1].x = myRandom(0.0, xMax);
-			asteroids[1].y = myRandom(0.0, yMax);
-			initAsteroid(&asteroids[2], ASTEROID_SMALL);
-			asteroids[2].x = myRandom(0.0, xMax);
-			asteroids[2].y = myRandom(0.0, yMax);
+			a = getInactiveAsteroid();
+			initAsteroid(a, ASTEROID_LARGE);
+			a->x = myRandom(0.0, xMax);
+			a->y = myRandom(0.0, yMax);
+			a = getInactiveAsteroid();
+			initAsteroid(a, ASTEROID_MEDIUM);
+			a->x = myRandom(0.0, xMax);
+			a->y = myRandom(0.0, yMax);
+			a = getInactiveAsteroid();
+			initAsteroid(a, ASTEROID_SMALL);
+			a->x = myRandom(0.0, xMax);
+			a->y = myRandom(0.0, yMax);
 
 			/* set the option values to the titlescreen */
 			selectedOption = 0;
@@ -826,15 +865,16 @@ changeState(int s)
 		}else if(s == STATE_HELP){
 			/* set the objects on the screen to show a help guide */
 			/* set up a stationary, rotating asteroid */
-			initAsteroid(&asteroids[0], ASTEROID_SMALL);
-			asteroids[0].x = xMax/12;
-			asteroids[0].y = yMax*0.39;
-			asteroids[0].phi = 0;
-			asteroids[0].dx = 0;
-			asteroids[0].dy = 0;
-			asteroids[0].dphi = 0.1;
-			asteroids[0].size = ASTEROID_SMALL;
-			asteroids[0].active = 1;
+			a = getInactiveAsteroid();
+			initAsteroid(a, ASTEROID_SMALL);
+			a->x = xMax/12;
+			a->y = yMax*0.39;
+			a->phi = 0;
+			a->dx = 0;
+			a->dy = 0;
+			a->dphi = 0.1;
+			a->size = ASTEROID_SMALL;
+			a->active = 1;
 
 			/* place a ship on the screen which the user can move aroud */
 			setShipHelpScreen();
@@ -842,62 +882,66 @@ changeState(int s)
 			upgradeText.lifetime = 0;
 
 			/* place an idle photon shot */
-			photons[0].active = 1;
+			shot = getInactivePhoton();
+			shot->active = 1;
 			photonSize = 3;
-			photons[0].x = xMax*0.90;
-			photons[0].y = yMax*0.59;
-
-			/* place a few pieces of debris */
-			debris[0].active = 1;
-			debris[0].x = xMax*0.03;
-			debris[0].y = yMax*0.07;
-			debris[0].dx = 0;
-			debris[0].dy = 0;
-			debris[0].phi = 0;
-			debris[0].dphi = 0.05;
-			debris[0].coords[0].x = 1.4;
-			debris[0].coords[0].y = 0.9;
-			debris[0].coords[1].x =	-1.5;
-			debris[0].coords[1].y = -1.0;
-			debris[0].coords[2].x = -1.0;
-			debris[0].coords[2].y = 0.9;
-			debris[0].lifetime = 2;
-			debris[0].active = 1;
-			debris[0].type = 1;
-
-			debris[1].active = 1;
-			debris[1].x = xMax*0.03;
-			debris[1].y = yMax*0.15;
-			debris[1].dx = 0;
-			debris[1].dy = 0;
-			debris[1].phi = 0;
-			debris[1].dphi = 0.15;
-			debris[1].coords[0].x = 1.0;
-			debris[1].coords[0].y = 0.8;
-			debris[1].coords[1].x =	-0.5;
-			debris[1].coords[1].y = -1.4;
-			debris[1].coords[2].x = -1.0;
-			debris[1].coords[2].y = 0.9;
-			debris[1].lifetime = 2;
-			debris[1].active = 1;
-			debris[1].type = 1;
-
-			debris[2].active = 1;
-			debris[2].x = xMax*0.92;
-			debris[2].y = yMax*0.14;
-			debris[2].dx = 0;
-			debris[2].dy = 0;
-			debris[2].phi = 0;
-			debris[2].dphi = 0.08;
-			debris[2].coords[0].x = 1.5;
-			debris[2].coords[0].y = 1.8;
-			debris[2].coords[1].x =	-1.2;
-			debris[2].coords[1].y = -1.8;
-			debris[2].coords[2].x = -1.6;
-			debris[2].coords[2].y = 1.3;
-			debris[2].lifetime = 2;
-			debris[2].active = 1;
-			debris[2].type = 2;
+			shot->x = xMax*0.90;
+			shot->y = yMax*0.59;
+
+			/* place a few pieces of debris. The pools were just cleared, so these take the first 3 debris slots that drawHelp keeps alive */
+			piece = getInactiveDebris();
+			piece->active = 1;
+			piece->x = xMax*0.03;
+			piece->y = yMax*0.07;
+			piece->dx = 0;
+			piece->dy = 0;
+			piece->phi = 0;
+			piece->dphi = 0.05;
+			piece->coords[0].x = 1.4;
+			piece->coords[0].y = 0.9;
+			piece->coords[1].x =	-1.5;
+			piece->coords[1].y = -1.0;
+			piece->coords[2].x = -1.0;
+			piece->coords[2].y = 0.9;
+			piece->lifetime = 2;
+			piece->active = 1;
+			piece->type = 1;
+
+			piece = getInactiveDebris();
+			piece->active = 1;
+			piece->x = xMax*0.03;
+			piece->y = yMax*0.15;
+			piece->dx = 0;
+			piece->dy = 0;
+			piece->phi = 0;
+			piece->dphi = 0.15;
+			piece->coords[0].x = 1.0;
+			piece->coords[0].y = 0.8;
+			piece->coords[1].x =	-0.5;
+			piece->coords[1].y = -1.4;
+			piece->coords[2].x = -1.0;
+			piece->coords[2].y = 0.9;
+			piece->lifetime = 2;
+			piece->active = 1;
+			piece->type = 1;
+
+			piece = getInactiveDebris();
+			piece->active = 1;
+			piece->x = xMax*0.92;
+			piece->y = yMax*0.14;
+			piece->dx = 0;
+			piece->dy = 0;
+			piece->phi = 0;
+			piece->dphi = 0.08;
+			piece->coords[0].x = 1.5;
+			piece->coords[0].y = 1.8;
+			piece->coords[1].x =	-1.2;
+			piece->coords[1].y = -1.8;
+			piece->coords[2].x = -1.6;
+			piece->coords[2].y = 1.3;
+			piece->lifetime = 2;
+			piece->active = 1;
+			piece->type = 2;
 		}else if(s == STATE_SHIPSELECT){
 			/* Show of the available ships the user can use */
 			selectedOption = 0;
@@ -914,7 +958,6 @@ changeState(int s)
 void
 clear()
 {
-	int i;
 	/*
 	 * Wipe the screen of objects. Used to reset/change a state
 	 */
@@ -923,21 +966,7 @@ clear()
 	levelTextLifetime = -1;
 	/* Set the max level the asteroids can reach */
 	maxLevel = 3;
-	for(i = 0; i < MAX_ASTEROIDS; i++){
-		asteroids[i].active = 0;
-	}
-	for(i = 0; i < MAX_DEBRIS; i++){
-		debris[i].active = 0;
-	}
-	for(i = 0; i < MAX_DUST; i++){
-		dust[i].active = 0;
-	}
-	for(i = 0; i < MAX_PHOTONS; i++){
-		photons[i].active = 0;
-	}
-	for(i = 0; i < MAX_POINTS; i++){
-		points[i].active = 0;
-	}
+	resetPools();
 
 	/* Set ship default values */
 	initShip();
@@ -970,56 +999,268 @@ optionSelect(){
 
 /* -- Timer Update Functions ------------------------------------------------- */
 
+void
+simulationTick()
+{
+	/*
+	 * Advance the game by a single fixed tick of TICK_LENGTH milliseconds. This is the main function of the game's logic
+	 * and for every game state, different functions are run on every tick. No GL calls are made here, so it can be run
+	 * without a window
+	 */
 
-/* -- File reading/writing functions -------------------------------------------------- */
+	/* run different sets of instructions depending on the game state */
+	if(state == STATE_TITLE){
+		/*Increment the oscillation variable and the background */
+		updateBackground();
+		incrementOscillation();
+
+		advanceAsteroid();
+	}else if(state == STATE_ASTEROIDS){
+		/*Increment the oscillation variable and the background */
+		updateBackground();
+		incrementOscillation();
+
+		/* use a set of functions to advance the objects' positions */
+		advanceDust();
+		advanceDebris();
+		advanceShip();
+		advancePhoton();
+		advanceAsteroid();
+		advancePoints();
+
+		/* test for and handle collisions */
+		collisionAsteroidPhoton();
+		collisionAsteroidShip();
+		collisionDebrisShip();
+
+		/* Lower the cooldown variable */
+		lowerCooldown();
+
+		/* Lower the "xDmg" ship variables that give the ship invincibility once hit */
+		updateDamage();
+
+		/* Update the text to decrement it's lifetime or to deactivate */
+		updateUpgradeText();
+
+		/* Update the next level text to display the current level/end level sequence */
+		updateLevelText();
+
+		/* Update the respawn timer used when the ship gets destroyed */
+		updateRespawn();
+
+	}else if(state == STATE_HELP){
+		/*Increment the oscillation variable and the background */
+		updateBackground();
+		incrementOscillation();
+
+		/* Enable certain updates to be done to allow the help screen to be helpful */
+		advanceAsteroid();
+		advanceDebris();
+		advanceDust();
+		advanceShip();
+		advancePoints();
+		updateUpgradeText();
+		collisionDebrisShip();
+	}else if(state  == STATE_SHIPSELECT){
+		/*Increment the oscillation variable and the background */
+		updateBackground();
+		incrementOscillation();
+
+		lowerCooldown();
+	}else if(state == STATE_SYSTEM){
+		advanceSystem();
+		if(windowState == 0){
+			/* Don't update the camera's position if there is a communications window up */
+			advanceCamera();
+		}
+		updateWindow();
+		updateShipPath();
+		updateSatellitePath(0);
+	}
+}
 
 void
-loadSavefile(){
+stepSimulation(int ticks)
+{
 	/*
-	 * Load the game starting from an empty state. Start by loading systemArray and then use the integer on the
-	 * final line to load the selectedSystem, which will be done with loadSystem().
+	 * Run the given amount of ticks back to back. Used by the timer callback and by headless runs
 	 */
-	int i, ii, iii;
-	FILE* loadStream = fopen("savefile", "r");
-	/* Create temp variables to hold system values */
-	int surfaceRows;
-	i = -1;
-
-	/* allocate enough memory to populate the systemArray */
-	systemArray = malloc(sizeof(System*)*SYSTEM_COUNT);
-
-	/* Loop the lines that populate the systemArray until we reach the final system line */
-	while(i < SYSTEM_COUNT - 1){
-		/* Scan the current system line and fetch the index */
-		printf("index read: %d\n", fscanf(loadStream, "[%d]", &i));
-		/* allocate the memory to create the system */
-		systemArray[i] = malloc(sizeof(System));
-		/* Scan the rest of the system line and opulate the allocated memory */
-		printf("system read: %d\n", fscanf(loadStream, " %[a-zA-Z -], %lf, %lf, %lf, %d\n", systemArray[i]->name, &systemArray[i]->x,
-				&systemArray[i]->y, &systemArray[i]->z, &systemArray[i]->planetCount));
-
-		/* Push the stream pointer past the star line */
-		fscanf(loadStream, "%*[^\n]%*c");
-
-		/* Push the stream pointer past the planets and their surface values */
-		for(ii = 0; ii < systemArray[i]->planetCount; ii++){
-			/* Read in the planet's row count and skip past the rest of the line */
-			printf("rows read: %d\n", fscanf(loadStream, "{%d, %*[^\n]%*c", &surfaceRows));
-			for(iii = 0; iii < surfaceRows; iii++){
-				/* Skip past the current surface line */
-				fscanf(loadStream, "%*[^\n]%*c");
-			}
-		}
+	int i;
+
+	for(i = 0; i < ticks; i++){
+		simulationTick();
+	}
+}
+
+
+/* -- File reading/writing functions -------------------------------------------------- */
+
+int
+loadSavefile()
+{
+	/*
+	 * Load the game starting from an empty state. Start by populating the systemArray from the savefile's
+	 * index table and then use the currentSystemIndex in the header to load the current system with loadSystem().
+	 * Returns 0 if the savefile could not be mapped or it's current system could not be loaded
+	 */
+	int i;
+	SaveHeader* header;
+	SaveIndex* index;
+
+	if(!mapSavefile()){
+		return 0;
 	}
+	header = (SaveHeader*) saveMap;
+	index = (SaveIndex*) (saveMap + sizeof(SaveHeader));
+
+	/* Restart the random streams from the savefile's seed so the game plays out the same way each time it is loaded */
+	seedRandom(header->seed);
 
-	/* Passing the final surface along with its other values means the next line will be the final line denoting the last value of currentSystemIndex */
-	printf("index read: %d\n", fscanf(loadStream, "[%d]", &i));
-	loadSystem(i);
+	/* The systemArray has already been allocated by initSystemViewer */
+	for(i = 0; i < header->systemCount && i < SYSTEM_COUNT; i++){
+		*systemArray[i] = index[i].system;
+	}
 
-	/* Now that we have populated the systemArray and the currentSystem, close the stream */
 	printf("start loading\n");
-	fclose(loadStream);
+	loadSystem(header->currentSystemIndex);
 	printf("done loading\n");
+
+	/* loadSystem leaves the currentSystem unset if the index is not in the savefile */
+	return currentSystem != NULL;
+}
+
+int
+importTextSavefile(char* textName)
+{
+	/*
+	 * Convert a savefile written in the old text format into the binary savefile. The text file is read from
+	 * start to end, writing each system's star, planets and surfaces as it's block and filling in the index table.
+	 * Everything is written to a temporary file that only replaces the savefile once the whole text file was read,
+	 * so a bad text file never destroys the savefile. Returns 0 if the text savefile could not be read or the binary
+	 * savefile could not be written
+	 */
+	int i, ii, r, c;
+	char* error;
+	SaveHeader header;
+	SaveIndex index;
+	SystemStar star;
+	SystemPlanet planet;
+	Surface surface;
+	FILE* textStream = fopen(textName, "r");
+	FILE* saveStream;
+
+	if(textStream == NULL){
+		printf("ERROR OPENING TEXT SAVEFILE %s\n", textName);
+		return 0;
+	}
+	saveStream = fopen(SAVEFILE_TEMP_NAME, "w+b");
+	if(saveStream == NULL){
+		printf("ERROR OPENING SAVEFILE %s FOR WRITING\n", SAVEFILE_TEMP_NAME);
+		fclose(textStream);
+		return 0;
+	}
+
+	/* Write the header and skip past the index table */
+	memcpy(header.magic, SAVEFILE_MAGIC, 4);
+	header.version = SAVEFILE_VERSION;
+	header.systemCount = SYSTEM_COUNT;
+	header.currentSystemIndex = 0;
+	header.seed = randomSeed;
+	header.reserved = 0;
+	fwrite(&header, sizeof(SaveHeader), 1, saveStream);
+	fseek(saveStream, sizeof(SaveHeader) + sizeof(SaveIndex)*SYSTEM_COUNT, SEEK_SET);
+
+	/* Every line is checked for the amount of values it should hold. error is set to what failed to be read */
+	error = NULL;
+	for(i = 0; i < SYSTEM_COUNT && error == NULL; i++){
+		/* The system line goes into the index entry */
+		if(fscanf(textStream, "[%*d] %49[a-zA-Z -], %lf, %lf, %lf, %d\n", index.system.name, &index.system.x,
+				&index.system.y, &index.system.z, &index.system.planetCount) != 5){
+			error = "SYSTEM";
+			break;
+		}
+		if(index.system.planetCount < 0 || index.system.planetCount > SAVEFILE_MAX_PLANETS){
+			error = "SYSTEM'S PLANET COUNT";
+			break;
+		}
+		index.offset = ftell(saveStream);
+
+		/* The star line starts the system's block */
+		if(fscanf(textStream, "%49[a-zA-Z -], %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf\n", star.name, &star.radius,
+				&star.orbitRadius, &star.axialTilt, &star.orbitTilt, &star.orbitOffset,
+				&star.dayOffset, &star.yearOffset, &star.daySpeed, &star.yearSpeed) != 10){
+			error = "STAR";
+			break;
+		}
+		fwrite(&star, sizeof(SystemStar), 1, saveStream);
+
+		for(ii = 0; ii < index.system.planetCount && error == NULL; ii++){
+			/* Each planet line is followed by it's surface lines, one per row */
+			if(fscanf(textStream, "{%d, %d}, %49[a-zA-Z -], %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf\n", &planet.surfaceRows, &planet.surfaceColumns,
+					planet.name, &planet.radius, &planet.type, &planet.orbitRadius, &planet.axialTilt, &planet.orbitTilt,
+					&planet.orbitOffset, &planet.dayOffset, &planet.yearOffset, &planet.daySpeed, &planet.yearSpeed) != 13){
+				error = "PLANET";
+				break;
+			}
+			if(planet.surfaceRows < 0 || planet.surfaceRows > SAVEFILE_MAX_ROWS
+					|| planet.surfaceColumns < 0 || planet.surfaceColumns > SAVEFILE_MAX_COLUMNS){
+				error = "PLANET'S SURFACE SIZE";
+				break;
+			}
+			planet.surface = NULL;
+			fwrite(&planet, sizeof(SystemPlanet), 1, saveStream);
+
+			for(r = 0; r < planet.surfaceRows && error == NULL; r++){
+				for(c = 0; c < planet.surfaceColumns; c++){
+					if(fscanf(textStream, "(%*d, %*d), %lf, %lf, %lf, %lf ", &surface.satellite, &surface.probe,
+							&surface.energy, &surface.mineral) != 4){
+						error = "SURFACE";
+						break;
+					}
+					fwrite(&surface, sizeof(Surface), 1, saveStream);
+				}
+				fscanf(textStream, "\n");
+			}
+		}
+
+		if(error == NULL){
+			writeSaveIndex(saveStream, i, &index);
+		}
+	}
+
+	/* The final line of the text savefile holds the currentSystemIndex */
+	if(error == NULL && (fscanf(textStream, "[%d]", &header.currentSystemIndex) != 1
+			|| header.currentSystemIndex < 0 || header.currentSystemIndex >= SYSTEM_COUNT)){
+		error = "CURRENT SYSTEM INDEX";
+	}
+	if(error == NULL){
+		fseek(saveStream, 0, SEEK_SET);
+		fwrite(&header, sizeof(SaveHeader), 1, saveStream);
+	}
+
+	fclose(textStream);
+	if(error != NULL){
+		printf("ERROR READING %s FROM TEXT SAVEFILE %s\n", error, textName);
+		fclose(saveStream);
+		remove(SAVEFILE_TEMP_NAME);
+		return 0;
+	}
+	if(fclose(saveStream) != 0){
+		printf("ERROR WRITING SAVEFILE %s\n", SAVEFILE_TEMP_NAME);
+		remove(SAVEFILE_TEMP_NAME);
+		return 0;
+	}
+
+	/* The savefile is about to be replaced, so it can not stay mapped */
+	unmapSavefile();
+	if(rename(SAVEFILE_TEMP_NAME, SAVEFILE_NAME) != 0){
+		printf("ERROR REPLACING SAVEFILE %s\n", SAVEFILE_NAME);
+		remove(SAVEFILE_TEMP_NAME);
+		return 0;
+	}
+
+	printf("imported %s into %s\n", textName, SAVEFILE_NAME);
+	return 1;
 }
 
 /* -- helper functions ------------------------------------------------------- */
@@ -1027,11 +1268,126 @@ loadSavefile(){
 double myRandom(double min, double max)
 {
 	/*
-	 * return a random number uniformly draw from [min,max]
+	 * return a random number uniformly draw from [min,max) using the gameplay stream
 	 */
-	double	d;
-	d = min+(max-min)*(rand()%0x7fff)/32767.0;
+	return streamRandom(&randomStreams[STREAM_GAMEPLAY], min, max);
+}
 
-	/* Return the value with up to 6 values past the decimal */
-	return ceil(d*1000000)/1000000;
+double
+effectRandom(double min, double max)
+{
+	/*
+	 * return a random number uniformly draw from [min,max) using the effects stream. Use this for anything that is only drawn,
+	 * so drawing a frame never changes the numbers the simulation gets
+	 */
+	return streamRandom(&randomStreams[STREAM_EFFECTS], min, max);
+}
+
+double
+universeRandom(double min, double max)
+{
+	/*
+	 * return a random number uniformly draw from [min,max) using the universe stream
+	 */
+	return streamRandom(&randomStreams[STREAM_UNIVERSE], min, max);
+}
+
+void
+seedRandom(unsigned int seed)
+{
+	/*
+	 * Start every random stream from the given seed. Each stream uses it's index as it's id
+	 */
+	int i;
+
+	randomSeed = seed;
+	for(i = 0; i < STREAM_COUNT; i++){
+		seedStream(&randomStreams[i], seed, i);
+	}
+}
+
+void
+seedStream(RandomStream *stream, unsigned int seed, unsigned int id)
+{
+	/*
+	 * Start a stream from a seed. The id selects one of many independent sequences for the same seed,
+	 * so workers can each be given their own stream
+	 */
+	stream->state = 0;
+	stream->increment = ((unsigned long long) id << 1) | 1;
+	nextRandom(stream);
+	stream->state += seed;
+	nextRandom(stream);
+}
+
+unsigned int
+nextRandom(RandomStream *stream)
+{
+	/*
+	 * Advance the stream and return it's next 32 bit number (PCG32: a linear congruential step with a permuted output)
+	 */
+	unsigned long long old;
+	unsigned int shifted, rotation;
+
+	old = stream->state;
+	stream->state = old*6364136223846793005ULL + stream->increment;
+	shifted = (unsigned int) (((old >> 18) ^ old) >> 27);
+	rotation = (unsigned int) (old >> 59);
+
+	return (shifted >> rotation) | (shifted << ((-rotation) & 31));
+}
+
+double
+streamRandom(RandomStream *stream, double min, double max)
+{
+	/*
+	 * return a random number uniformly draw from [min,max) using the given stream
+	 */
+	return min + (max - min)*(nextRandom(stream)/4294967296.0);
+}
+
+void
+fillRandom(RandomStream *stream, double *values, int count, double min, double max)
+{
+	/*
+	 * Fill the array with count random numbers uniformly draw from [min,max) using the given stream
+	 */
+	int i;
+	double scale;
+
+	scale = (max - min)/4294967296.0;
+	for(i = 0; i < count; i++){
+		values[i] = min + scale*nextRandom(stream);
+	}
+}
+
+void
+setCapacity(int* capacity, char* value)
+{
+	/*
+	 * Set the capacity of an object pool from a command line value. The default capacity is kept if the value is below MIN_CAPACITY
+	 */
+	int count;
+
+	count = atoi(value);
+	if(count < MIN_CAPACITY){
+		printf("ERROR: capacity %s is below %d, keeping %d\n", value, MIN_CAPACITY, *capacity);
+		return;
+	}
+	*capacity = count;
+}
+
+char*
+optionValue(char *argv[], int* i)
+{
+	/*
+	 * Return the value that follows the command line option at i and move i onto it. The program
+	 * exits if the option is the last argument, since every option needs a value
+	 */
+	if(argv[*i + 1] == NULL){
+		printf("ERROR: option %s is missing it's value\n", argv[*i]);
+		exit(1);
+	}
+	(*i)++;
+	return argv[*i];
 }
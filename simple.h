@@ -30,6 +30,14 @@
 //3D View of the system with all it's planets
 #define STATE_SYSTEM 4
 
+/* The random number streams. Each part of the game draws from it's own stream so using more random numbers in one part
+ * does not change the numbers another part gets. Gameplay is the asteroids simulation, effects are only used for
+ * drawing and universe is used to generate the systems */
+#define STREAM_GAMEPLAY 0
+#define STREAM_EFFECTS 1
+#define STREAM_UNIVERSE 2
+#define STREAM_COUNT 3
+
 
 /* -- Global Type Definitions ------------------------------------------------------------------------------------ */
 
@@ -59,6 +67,15 @@ typedef struct Player{
 } Player;
 #endif
 
+#ifndef GLOBAL_HEADER_RANDOM
+#define GLOBAL_HEADER_RANDOM
+/* A stream of pseudo random numbers using PCG32. The stream's whole state is kept here, so each stream
+ * can be used on it's own without affecting any other stream */
+typedef struct RandomStream{
+	unsigned long long state, increment;
+} RandomStream;
+#endif
+
 
 /* --- Global Variables ------------------------------------------------------------------------------------- */
 
@@ -74,14 +91,29 @@ extern int	up, down, left, right;
 /* The main player struct along with their stats */
 static Player player;
 
+/* The seed that every random stream started from. It is stored in the savefile so a game can be replayed */
+static unsigned int randomSeed;
+static RandomStream randomStreams[STREAM_COUNT];
+
 
 /* --- Global Functions ----------------------------------------------------------------------------------------- */
 
 /* Change the state of the game using a constant as a perameter. Must be able to be called from anywhere in the code */
 static void changeState(int s);
 
-/* Return a random value between min and max. Has a limit to how many digits can preceed the decimal point */
+/* Return a random value between min and max from the gameplay, effects or universe stream */
 static double myRandom(double min, double max);
+static double effectRandom(double min, double max);
+static double universeRandom(double min, double max);
+
+/* Start every stream from one seed, or a single stream from a seed and it's own id so streams with the same seed differ */
+static void seedRandom(unsigned int seed);
+static void seedStream(RandomStream *stream, unsigned int seed, unsigned int id);
+
+/* Return the next number of a stream, return a value between min and max or fill an array with values between min and max */
+static unsigned int nextRandom(RandomStream *stream);
+static double streamRandom(RandomStream *stream, double min, double max);
+static void fillRandom(RandomStream *stream, double *values, int count, double min, double max);
 
 /* This should be removed once the clear function has been isolated into the state change function */
 static void clear();
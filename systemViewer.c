@@ -37,9 +37,46 @@ typedef struct SystemPlanet{
 	 * Normal/default 	= {0.20, 1.00]
 	 */
 	double type;
-	Surface*** surface;
+	/* All of the planet's surfaces, stored row by row. Use getSurface() to find a single section */
+	Surface* surface;
 } SystemPlanet;
 
+/* The surface section at row r and column c of the given planet */
+#define getSurface(planet, r, c) (&(planet)->surface[(r)*(planet)->surfaceColumns + (c)])
+
+/* This may want to be formed with the coords, but that will require a lot of changes with asteroids.
+ * This is just the coordinates of a point in 3D space */
+typedef struct Point{
+	double x, y, z;
+} Point;
+
+/* One triangle section of a planet's scanning grid. The normal and d form the plane of the section: Nx*x + Ny*y + Nz*z + d = 0 */
+typedef struct ScanSection{
+	Point A, B, C;
+	Point normal;
+	double d;
+} ScanSection;
+
+/* The scanning grid around a planet, built once when the planet is loaded since it only depends on the planet's radius.
+ * The sections are stored in the same row by row order as the planet's surfaces. rowTop and rowBottom are the heights
+ * of each row's edges, used to find which row the camera is focusing on */
+typedef struct ScanGrid{
+	int rows, columns;
+	double *rowTop, *rowBottom;
+	ScanSection *section;
+} ScanGrid;
+
+/* The orbit of a planet as a loop of points around the star, built once when the planet is loaded. The amount of segments
+ * is chosen so the distance between the line and the true circle is never more than ORBIT_LINE_ERROR of the distance the
+ * camera is closest to the orbit from, which is when the planet is focused on */
+#define ORBIT_LINE_ERROR 0.001
+#define ORBIT_LINE_MIN_SEGMENTS 32
+
+typedef struct OrbitLine{
+	int segments;
+	GLfloat *vertex;
+} OrbitLine;
+
 /* A unique type to hold more system information than the regular System struct. Used only by currentSystem */
 typedef struct CurrentSystemType{
 	char name[NAME_LENGTH];
@@ -47,6 +84,9 @@ typedef struct CurrentSystemType{
 	int planetCount;
 	SystemStar *star;
 	SystemPlanet **planet;
+	/* The scanning grid and orbit line of each planet, in the same order as the planet array */
+	ScanGrid *scanGrid;
+	OrbitLine *orbit;
 } CurrentSystemType;
 
 /* Hold basic information of a system */
@@ -73,11 +113,47 @@ typedef struct Camera{
 	int camR, camC;
 } Camera;
 
-/* This may want to be formed with the coords, but that will require a lot of changes with asteroids.
- * This is just the coordinates of a point in 3D space */
-typedef struct Point{
-	double x, y, z;
-} Point;
+/* A block of memory that is handed out in order and released all at once. Used to hold everything allocated for the currentSystem */
+#define ARENA_ALIGNMENT 16
+
+typedef struct Arena{
+	char* memory;
+	size_t size, used;
+} Arena;
+
+/* The binary savefile. It starts with a SaveHeader followed by a SaveIndex for every system. Each index entry holds
+ * the system's stats and the offset to it's block, which is the star followed by every planet and that planet's
+ * rows*columns surfaces. Blocks never change size, so a system can be loaded or saved with a single seek */
+#define SAVEFILE_NAME "savefile.dat"
+#define SAVEFILE_MAGIC "ASAV"
+#define SAVEFILE_VERSION 2
+
+/* A text savefile is imported into SAVEFILE_TEMP_NAME first. The limits are far above anything randomSystem creates and
+ * are only used to reject broken savefiles */
+#define SAVEFILE_TEMP_NAME "savefile.dat.tmp"
+#define SAVEFILE_MAX_PLANETS 100
+#define SAVEFILE_MAX_ROWS 256
+#define SAVEFILE_MAX_COLUMNS 1024
+
+typedef struct SaveHeader{
+	char magic[4];
+	int version;
+	int systemCount;
+	int currentSystemIndex;
+	unsigned int seed;
+	/* Unused, keeps the header a multiple of 8 bytes */
+	unsigned int reserved;
+} SaveHeader;
+
+typedef struct SaveIndex{
+	long offset;
+	System system;
+} SaveIndex;
+
+/* The savefile is used in place through it's mapping, so every index entry and block has to start 8 byte aligned for it's
+ * doubles and longs. The blocks are made of records holding doubles, so only the header and index need to be checked */
+_Static_assert(sizeof(SaveHeader) % 8 == 0, "SaveHeader must keep the savefile 8 byte aligned");
+_Static_assert(sizeof(SaveIndex) % 8 == 0, "SaveIndex must keep the savefile 8 byte aligned");
 
 
 /* --- Local Variables ------------------------------------------------------------------------------ */
@@ -135,6 +211,40 @@ static double energyLimit;
 /* The state of the communication window, with any value above 0 being "visibile" and prevent inputs */
 static double windowState;
 
+/* Satellites and probes of the currentSystem that are on their way to orbit. Each entry points to the satellite or probe value
+ * of a surface, and is removed once that value reaches 1. Rebuilt on each system load */
+static double** launchList;
+static int launchCount;
+static int launchCapacity;
+
+/* Owns all memory allocated for the currentSystem. It is reset on each system load instead of freeing the system piece by piece */
+static Arena systemArena;
+
+/* The whole savefile mapped into memory. The currentSystem's star and surfaces point straight into it, so any change
+ * to them is written back to the savefile by the OS, and only for the pages that were changed */
+static char* saveMap;
+static size_t saveMapSize;
+
+/* The position of every system except the current one in the skybox, and the systems that are within jumping range in the
+ * order they are selected. Both only change on a jump, so they are filled by calculateBackgroundStars. The skybox's
+ * points and the jump lines are compiled into two display lists the next time they are drawn, starting at skyboxList */
+static GLfloat* skyboxVertex;
+static int skyboxCount;
+static int* nearbyIndex;
+static int nearbyCount;
+static GLuint skyboxList;
+static int skyboxChanged;
+
+/* Unit spheres of decreasing detail compiled into display lists starting at sphereList. Each star and planet is drawn by
+ * scaling the level chosen from how large it will appear on the screen. sphereProjected is the smallest ratio of the
+ * radius to the distance from the camera that a level is used for */
+#define SPHERE_LODS 3
+
+static GLuint sphereList;
+static const int sphereSlices[SPHERE_LODS] = {30, 18, 10};
+static const int sphereStacks[SPHERE_LODS] = {20, 12, 6};
+static const double sphereProjected[SPHERE_LODS] = {0.1, 0.02, 0};
+
 /* -- Color variables (3D) ------------------------------------------------------------------ */
 
 /* HUD's text */
@@ -245,7 +355,13 @@ static void calculateBackgroundStars();
 static void systemJump();
 static void systemSelectMenu();
 static void gridIncrement(int incrementor, double* value, double radius, double multiplier);
+static void scanGridSize(double radius, int* rows, int* columns);
+static void scanGridPoint(Point* point, double radius, double ii, double iii, double rowMultiplier, double columnMultiplier);
+static void buildScanGrid(SystemPlanet* planet, ScanGrid* grid);
+static int orbitSegments(SystemPlanet* planet);
+static void buildOrbitLine(SystemPlanet* planet, OrbitLine* orbit);
 static void systemLaunchSatellite();
+static void addLaunch(double* path);
 static void setColor(int colorID);
 static void setColorValue(double r, double g, double b);
 
@@ -254,6 +370,10 @@ static void drawSystem();
 static void drawSystemStar();
 static void drawSystemPlanet();
 static void drawSystemBackground();
+static void buildSkybox();
+static void drawSphere(double radius, double distance);
+static void orbitPosition(double orbitOffset, double orbitTilt, double yearOffset, double orbitRadius, Point* position);
+static double cameraDistance(Point* position);
 static void drawCameraHUD();
 static void drawCamera();
 static void drawOrbitLines();
@@ -277,6 +397,14 @@ static void updateSatellitePath(int increment);
 /* Functions that operate with outside files such as the savefile */
 static void loadSystem(int newSystemIndex);
 static void saveSystem();
+static int mapSavefile();
+static int validSavefile();
+static void unmapSavefile();
+
+/* Functions that hand out memory from an arena */
+static void arenaReset(Arena* arena, size_t size);
+static void* arenaAlloc(Arena* arena, size_t size);
+static void writeSaveIndex(FILE* stream, int systemIndex, SaveIndex* index);
 
 
 /* --- Initilization functions ------------------------------------------------------------------ */
@@ -608,16 +736,20 @@ drawCamera()
 {
 	/*
 	 * Draw the camera's position and lookAt target. The target and position is
-	 * modified by the camera's focus value
+	 * modified by the camera's focus value. The camera's x, y and z are set to it's position in the system
+	 * so the stars and planets can find how far they are from it. When focused on a star or planet, the
+	 * camera's offset from that body is not rotated along with the body, which is close enough for the
+	 * sphere's level of detail
 	 */
+	Point eye, body;
 
 	if((camera->focus == 0 && selectedAstronomicalObject == 0) || camera->focus == 1){
 		/* Focus on the entire system */
 		//An odd error comes up when gluLookAt(0, ...) is done. Prevent this from happening by limiting the angles
-		gluLookAt(((currentSystem->planet[currentSystem->planetCount-1]->orbitRadius + currentSystem->star->radius)*1.2)*cos(camera->xAngle),
-				((currentSystem->planet[currentSystem->planetCount-1]->orbitRadius + currentSystem->star->radius)*1.2)*cos(camera->yAngle),
-				((currentSystem->planet[currentSystem->planetCount-1]->orbitRadius + currentSystem->star->radius)*1.2)*sin(camera->xAngle),
-				0, 0, 0, 0.0, 1.0, 0.0);
+		camera->x = ((currentSystem->planet[currentSystem->planetCount-1]->orbitRadius + currentSystem->star->radius)*1.2)*cos(camera->xAngle);
+		camera->y = ((currentSystem->planet[currentSystem->planetCount-1]->orbitRadius + currentSystem->star->radius)*1.2)*cos(camera->yAngle);
+		camera->z = ((currentSystem->planet[currentSystem->planetCount-1]->orbitRadius + currentSystem->star->radius)*1.2)*sin(camera->xAngle);
+		gluLookAt(camera->x, camera->y, camera->z, 0, 0, 0, 0.0, 1.0, 0.0);
 		glPushMatrix();
 		glTranslated(currentSystem->planet[currentSystem->planetCount-1]->orbitRadius*1.2*cos(camera->xAngle),
 				currentSystem->planet[currentSystem->planetCount-1]->orbitRadius*cos(camera->yAngle),
@@ -627,10 +759,14 @@ drawCamera()
 		glPopMatrix();
 	}else if(selectedAstronomicalObject <= 1){
 		/* Focus on the system's selected star */
-		gluLookAt((currentSystem->star->radius*7.5)*cos(camera->xAngle)*sin(camera->yAngle),
-				(currentSystem->star->radius*7.5)*cos(camera->yAngle),
-				(currentSystem->star->radius*7.5)*sin(camera->xAngle)*sin(camera->yAngle),
-				0, 0, 0, 0.0, 1.0, 0.0);
+		eye.x = (currentSystem->star->radius*7.5)*cos(camera->xAngle)*sin(camera->yAngle);
+		eye.y = (currentSystem->star->radius*7.5)*cos(camera->yAngle);
+		eye.z = (currentSystem->star->radius*7.5)*sin(camera->xAngle)*sin(camera->yAngle);
+		gluLookAt(eye.x, eye.y, eye.z, 0, 0, 0, 0.0, 1.0, 0.0);
+		orbitPosition(0, currentSystem->star->orbitTilt, 0, currentSystem->star->orbitRadius, &body);
+		camera->x = body.x + eye.x;
+		camera->y = body.y + eye.y;
+		camera->z = body.z + eye.z;
 		/* Reverse the render process of the star to focus on to return the matrix to the origin (inside the main star))*/
 		glRotated(90, 1, 0, 0);
 		glRotated(360*-currentSystem->star->dayOffset, 0.0, 0.0, 1.0);
@@ -642,10 +778,15 @@ drawCamera()
 		glRotated(-currentSystem->star->orbitOffset, 0.0, 1.0, 0.0);
 	}else if(selectedAstronomicalObject <= currentSystem->planetCount + 1){
 		/* Focus on the system's selected planet */
-		gluLookAt(((2 + currentSystem->planet[selectedAstronomicalObject - 2]->radius/4.0)*7.5)*cos(camera->xAngle)*sin(camera->yAngle),
-				((2 + currentSystem->planet[selectedAstronomicalObject - 2]->radius/4.0)*7.5)*cos(camera->yAngle),
-				((2 + currentSystem->planet[selectedAstronomicalObject - 2]->radius/4.0)*7.5)*sin(camera->xAngle)*sin(camera->yAngle),
-				0, 0, 0, 0.0, 1.0, 0.0);
+		eye.x = ((2 + currentSystem->planet[selectedAstronomicalObject - 2]->radius/4.0)*7.5)*cos(camera->xAngle)*sin(camera->yAngle);
+		eye.y = ((2 + currentSystem->planet[selectedAstronomicalObject - 2]->radius/4.0)*7.5)*cos(camera->yAngle);
+		eye.z = ((2 + currentSystem->planet[selectedAstronomicalObject - 2]->radius/4.0)*7.5)*sin(camera->xAngle)*sin(camera->yAngle);
+		gluLookAt(eye.x, eye.y, eye.z, 0, 0, 0, 0.0, 1.0, 0.0);
+		orbitPosition(currentSystem->planet[selectedAstronomicalObject-2]->orbitOffset, currentSystem->planet[selectedAstronomicalObject-2]->orbitTilt,
+				currentSystem->planet[selectedAstronomicalObject-2]->yearOffset, currentSystem->planet[selectedAstronomicalObject-2]->orbitRadius, &body);
+		camera->x = body.x + eye.x;
+		camera->y = body.y + eye.y;
+		camera->z = body.z + eye.z;
 		/* Reverse the render process of the planet to focus on to return the matrix to the origin (inside the main star)*/
 		glRotated(90, 1, 0, 0);
 		glRotated(360*-currentSystem->planet[selectedAstronomicalObject-2]->dayOffset, 0.0, 0.0, 1.0);
@@ -664,7 +805,9 @@ drawSystemStar()
 	/*
 	 * Draw the current system's star
 	 */
+	Point starPosition;
 
+	orbitPosition(0, currentSystem->star->orbitTilt, 0, currentSystem->star->orbitRadius, &starPosition);
 	glColor3f(1.0, 0.5, 0.2);
 	glPushMatrix();
 	glRotated(currentSystem->star->orbitTilt, 1.0, 0.0, 0.0);
@@ -673,7 +816,7 @@ drawSystemStar()
 	glRotated(90.0 + currentSystem->star->orbitTilt, 1.0, 0.0, 0.0);
 	glRotated(360*currentSystem->star->dayOffset, 0.0, 0.0, 1.0);
 	glRotated(currentSystem->star->axialTilt, 0.0, 1.0, 0.0);
-	glutSolidSphere(currentSystem->star->radius,30,20);
+	drawSphere(currentSystem->star->radius, cameraDistance(&starPosition));
 
 	/* Position the primary light source inside the star*/
 	GLfloat position[] = { 0, 0, 0, 1.0 };
@@ -681,6 +824,70 @@ drawSystemStar()
 	glPopMatrix();
 }
 
+void
+drawSphere(double radius, double distance)
+{
+	/*
+	 * Draw a sphere of the given radius centered on the current position. The level of detail is chosen from the ratio of
+	 * the radius to the given distance between the sphere and the camera
+	 */
+	int level;
+
+	if(sphereList == 0){
+		/* Build the unit spheres the first time one is drawn */
+		sphereList = glGenLists(SPHERE_LODS);
+		for(level = 0; level < SPHERE_LODS; level++){
+			glNewList(sphereList + level, GL_COMPILE);
+			glutSolidSphere(1, sphereSlices[level], sphereStacks[level]);
+			glEndList();
+		}
+	}
+
+	for(level = 0; level < SPHERE_LODS - 1; level++){
+		if(radius >= distance*sphereProjected[level]){
+			break;
+		}
+	}
+
+	glPushMatrix();
+	glScaled(radius, radius, radius);
+	glCallList(sphereList + level);
+	glPopMatrix();
+}
+
+void
+orbitPosition(double orbitOffset, double orbitTilt, double yearOffset, double orbitRadius, Point* position)
+{
+	/*
+	 * Find the position of a body in the system. It's place along the orbit is rotated by orbitTilt degrees around
+	 * the X axis then orbitOffset degrees around the Y axis, the same way the body is positioned when drawn
+	 */
+	double x, y, z, offset, tilt;
+
+	offset = orbitOffset*M_PI/180;
+	tilt = orbitTilt*M_PI/180;
+	x = cos(2*M_PI*yearOffset)*orbitRadius;
+	z = sin(2*M_PI*yearOffset)*orbitRadius;
+
+	/* Tilt the orbit around the X axis */
+	y = -z*sin(tilt);
+	z = z*cos(tilt);
+
+	/* Turn the orbit around the Y axis */
+	position->x = x*cos(offset) + z*sin(offset);
+	position->y = y;
+	position->z = -x*sin(offset) + z*cos(offset);
+}
+
+double
+cameraDistance(Point* position)
+{
+	/*
+	 * Return the distance between the given position and the camera, which drawCamera has placed for this frame
+	 */
+	return sqrt(pow(position->x - camera->x, 2) + pow(position->y - camera->y, 2) + pow(position->z - camera->z, 2));
+}
+
 void
 drawSystemPlanet()
 {
@@ -689,11 +896,9 @@ drawSystemPlanet()
 	 */
 	int i;
 	int r, c;
+	Point position;
 	camera->camR = -1;
 	camera->camC = -1;
-	int odd = 0;
-	double ii, iii;
-	double nextii;
 	double largest = 0;
 
 	for(i = 0; i < currentSystem->planetCount; i++){
@@ -708,7 +913,9 @@ drawSystemPlanet()
 		glRotated(currentSystem->planet[i]->axialTilt, 0.0, 1.0, 0.0);
 		glRotated(360*currentSystem->planet[i]->dayOffset, 0.0, 0.0, 1.0);
 		setColor(COLOR_PLANET);
-		glutSolidSphere(currentSystem->planet[i]->radius,30,20);
+		orbitPosition(currentSystem->planet[i]->orbitOffset, currentSystem->planet[i]->orbitTilt, currentSystem->planet[i]->yearOffset,
+				currentSystem->planet[i]->orbitRadius, &position);
+		drawSphere(currentSystem->planet[i]->radius, cameraDistance(&position));
 
 		/* Draw the satellites currently in flight for the planet that is currently selected */
 		if(selectedAstronomicalObject == i + 2){
@@ -728,18 +935,19 @@ drawSystemPlanet()
 			glPopMatrix();
 		}
 
-		/* Draw the scanning grid around the planet if the user selected the scanning option for this planet. Initialize a set
-		 * of variables used to draw the grid and to specify which section the camera is focusing on */
+		/* Draw the scanning grid around the planet if the user selected the scanning option for this planet. The grid's
+		 * sections were built when the system was loaded, so only the colors and the section the camera is focusing on change */
 		if(displayedHUD == 3 && selectedAstronomicalObject == i + 2){
-			double Ax, Ay, Az, Bx, By, Bz, Cx, Cy, Cz;
-			double ABx, ABy, ABz, ACx, ACy, ACz;
-			double Nx, Ny, Nz, d;
 			double camX, camY, camZ, value;
+			int focusRow;
+			ScanGrid* grid = &currentSystem->scanGrid[i];
+			ScanSection* section;
+			Surface* surface;
 			glRotated(90, 1, 0, 0);
 			setColor(COLOR_SCAN_GRID);
 
-			/* To find whether the camera's focus point is within a section, use the three points of the section's triangle to form
-			 * a plane. If the camera's focus point is above the plane (positive when put into the plane equation) then it's within the section.
+			/* To find whether the camera's focus point is within a section, use the plane of the section's triangle.
+			 * If the camera's focus point is above the plane (positive when put into the plane equation) then it's within the section.
 			 * Any value behind the plane (negative) would be on the outside of the sector due to the spherical nature of the planet */
 			/* Find the value obtained when placing the camera's point onto the planet's scanning grid */
 			camX = currentSystem->planet[i]->radius*1.2*cos(camera->xAngle)*sin(camera->yAngle);
@@ -747,179 +955,28 @@ drawSystemPlanet()
 			camZ = -currentSystem->planet[i]->radius*1.2*sin(camera->xAngle)*sin(camera->yAngle);
 
 			/* Draw a grid comprised of triangles around the planet that ends before the top and bottom of the planet */
-			odd = 0;
-			r = 0;
-			/* The ii value determines the rows from the top to bottom of the planet, where 0.0 is at
-			 * the bottom and 0.5 is at the top. values above 0.5 simply continue past the top and around the sphere. */
-			for(ii = 0.15; ceil(ii*100000)/100000 < 0.35; gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1)){
-				r++;
-				c = 0;
-				/* The iii value determines the width of the columns around the sphere. The larger the jump between values, the wider the space */
-				for(iii = 0; ceil(iii*100000)/100000 < 1; gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1)){
-					/* Calcualte the points used to for a triangle section of the grid. The grid is formed of two triangle types:
-					 * One points up and the other points down. There are equal amounts of both and always begin with the right-side up */
-					c++;
-					if(odd){
-						/* If it's an odd row (1st from the bottom, 3rd from the bottom, etc) add an offset to the triangles */
-						gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5);
-					}
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.025000);
-					Ax = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					Ay = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Az = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.025000);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -0.025000);
-
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1 -0.025000);
-					Bx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					By = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Bz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -1 +0.025000);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -0.025000);
-
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1 -0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5);
-					Cx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					Cy = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Cz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.5);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -1 +0.025000);
-					if(odd){
-						/* Revert the offset if there was one applied */
-						gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.5);
-					}
-
-					/* Use the set points to draw the section */
-					/* Make the grid color relative to the status of it's satellites */
-					if(currentSystem->planet[i]->surface[r-1][c-1]->satellite >= 1 || currentSystem->planet[i]->surface[r-1][c-1]->probe >= 1){
-						if(currentSystem->planet[i]->surface[r-1][c-1]->satellite >= 1){
-							if(currentSystem->planet[i]->surface[r-1][c-1]->probe >= 1){
-								/* satellite and probe are present, making the color green */
-								setColorValue(0, 1, 0);
-							}else if(currentSystem->planet[i]->surface[r-1][c-1]->energy > energyLimit && currentSystem->planet[i]->surface[r-1][c-1]->mineral > mineralLimit){
-								/* Satellite is present without a probe and cannot detect energy/mineral, making the color green */
-								setColorValue(0, 1, 0);
-							}else{
-								/* Satellite is present without a probe, and there is a source of energy/mineral detected, making it yellow */
-								setColorValue(1, 1, 0);
-							}
-						}else if(currentSystem->planet[i]->surface[r-1][c-1]->probe >= 1){
-							/* No satellite but probe is present, making it blue */
-							setColorValue(0, 0, 1);
-						}
-					}else{
-						/* Set the color to red if there are no satellites in orbit */
-						setColorValue(1, 0, 0);
-					}
-
-
-					glBegin(GL_LINES);
-					glVertex3f(Ax, Ay, Az);
-					glVertex3f(Bx, By, Bz);
-					glVertex3f(Bx, By, Bz);
-					glVertex3f(Cx, Cy, Cz);
-					glVertex3f(Cx, Cy, Cz);
-					glVertex3f(Ax, Ay, Az);
-					glEnd();
-
-					/* Check if this is the row that the camera is focusing on to find the section the user is selecting */
-					nextii = ii;
-					gridIncrement(0, &nextii, currentSystem->planet[i]->radius, 1);
-					//(ii + 0.2/ceil((currentSystem->planet[i]->radius + 5)/3))*2*M_PI
-					if(currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI) >=
-							-currentSystem->planet[i]->radius*1.2*cos(camera->yAngle) &&
-							currentSystem->planet[i]->radius*1.2*cos(nextii*2*M_PI) <
-							-currentSystem->planet[i]->radius*1.2*cos(camera->yAngle)){
-						/* Use the cross product to find two vectors used to form the plane of the section */
-						ABx = Bx - Ax;
-						ABy = By - Ay;
-						ABz = Bz - Az;
-						ACx = Cx - Ax;
-						ACy = Cy - Ay;
-						ACz = Cz - Az;
-
-						/* Find the normal vector of the plane */
-						Nx = (ABy * ACz) - (ABz * ACy);
-						Ny = (ABz * ACx) - (ABx * ACz);
-						Nz = (ABx * ACy) - (ABy * ACx);
-
-						/* Plane equation: Nx*x + Ny*y + Nz*z + d = 0. Plug in any point (in our case, [Ax, Ay, Az]) to find the value of d */
-						d = -(Nx*Ax + Ny*Ay + Nz*Az);
-
-						/* Find the value obtained when placing the camera's point onto the plane */
-						camX = currentSystem->planet[i]->radius*1.2*cos(camera->xAngle)*sin(camera->yAngle);
-						camY = -currentSystem->planet[i]->radius*1.2*cos(camera->yAngle);
-						camZ = -currentSystem->planet[i]->radius*1.2*sin(camera->xAngle)*sin(camera->yAngle);
-						value = Nx*camX + Ny*camY + Nz*camZ + d;
-
-						/* Save the largest value and track what row and column it was in */
-						if(largest < value){
-							largest = value;
-							camera->camC = c;
-							camera->camR = r;
-						}
-					}
-
-					/* Draw the surface's contents if there is a probe or satellite in orbit */
-					if(currentSystem->planet[i]->surface[r-1][c-1]->satellite >= 1 || currentSystem->planet[i]->surface[r-1][c-1]->probe >= 1){
-						drawSurfaceContents(i, r-1, c-1, Ax, Ay, Az, Cx, Cy, Cz, Bx, By, Bz);
-					}
-
-					/*
-					 * Now initialize and draw the upside-down triangle that points down. It is the same general process as before
-					 */
-					c++;
-					if(odd){
-						/* If it's an odd row (1st from the bottom, 3rd from the bottom, etc) add an offset to the triangles */
-						gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5);
-					}
+			for(r = 0; r < grid->rows; r++){
+				/* Check if this is the row that the camera is focusing on to find the section the user is selecting */
+				focusRow = grid->rowTop[r] >= camY && grid->rowBottom[r] < camY;
 
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1.5 -0.025000);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1 -0.025000);
-					Ax = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					Ay = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Az = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -1 +0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -1.5 +0.025000);
-
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1 -0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5 +0.025000);
-					Bx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					By = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Bz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.5 -0.025000);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -1 +0.025000);
-
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1);
-					Cx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					Cy = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Cz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -1);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -0.025000);
-
-					if(odd){
-						/* Revert the offset if there was one applied */
-						gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.5);
-					}
+				for(c = 0; c < grid->columns; c++){
+					section = &grid->section[r*grid->columns + c];
+					surface = getSurface(currentSystem->planet[i], r, c);
 
-					/* Use the set points to draw the section */
 					/* Make the grid color relative to the status of it's satellites */
-					if(currentSystem->planet[i]->surface[r-1][c-1]->satellite >= 1 || currentSystem->planet[i]->surface[r-1][c-1]->probe >= 1){
-						if(currentSystem->planet[i]->surface[r-1][c-1]->satellite >= 1){
-							if(currentSystem->planet[i]->surface[r-1][c-1]->probe >= 1){
+					if(surface->satellite >= 1 || surface->probe >= 1){
+						if(surface->satellite >= 1){
+							if(surface->probe >= 1){
 								/* satellite and probe are present, making the color green */
 								setColorValue(0, 1, 0);
-							}else if(currentSystem->planet[i]->surface[r-1][c-1]->energy > energyLimit && currentSystem->planet[i]->surface[r-1][c-1]->mineral > mineralLimit){
+							}else if(surface->energy > energyLimit && surface->mineral > mineralLimit){
 								/* Satellite is present without a probe and cannot detect energy/mineral, making the color green */
 								setColorValue(0, 1, 0);
 							}else{
 								/* Satellite is present without a probe, and there is a source of energy/mineral detected, making it yellow */
 								setColorValue(1, 1, 0);
 							}
-						}else if(currentSystem->planet[i]->surface[r-1][c-1]->probe >= 1){
+						}else if(surface->probe >= 1){
 							/* No satellite but probe is present, making it blue */
 							setColorValue(0, 0, 1);
 						}
@@ -928,174 +985,51 @@ drawSystemPlanet()
 						setColorValue(1, 0, 0);
 					}
 
+					/* Use the set points to draw the section */
 					glBegin(GL_LINES);
-					glVertex3f(Ax, Ay, Az);
-					glVertex3f(Bx, By, Bz);
-					glVertex3f(Bx, By, Bz);
-					glVertex3f(Cx, Cy, Cz);
-					glVertex3f(Cx, Cy, Cz);
-					glVertex3f(Ax, Ay, Az);
+					glVertex3f(section->A.x, section->A.y, section->A.z);
+					glVertex3f(section->B.x, section->B.y, section->B.z);
+					glVertex3f(section->B.x, section->B.y, section->B.z);
+					glVertex3f(section->C.x, section->C.y, section->C.z);
+					glVertex3f(section->C.x, section->C.y, section->C.z);
+					glVertex3f(section->A.x, section->A.y, section->A.z);
 					glEnd();
 
-					/* Check if this is the row that the camera is focusing on to find the section the user is selecting */
-					nextii = ii;
-					gridIncrement(0, &nextii, currentSystem->planet[i]->radius, 1);
-					if(currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI) >=
-							-currentSystem->planet[i]->radius*1.2*cos(camera->yAngle) &&
-							currentSystem->planet[i]->radius*1.2*cos(nextii*2*M_PI) <
-							-currentSystem->planet[i]->radius*1.2*cos(camera->yAngle)){
-						/* Use the cross product to find two vectors used to form the plane of the section */
-						ABx = Bx - Ax;
-						ABy = By - Ay;
-						ABz = Bz - Az;
-						ACx = Cx - Ax;
-						ACy = Cy - Ay;
-						ACz = Cz - Az;
-
-						/* Find the normal vector of the plane */
-						Nx = (ABy * ACz) - (ABz * ACy);
-						Ny = (ABz * ACx) - (ABx * ACz);
-						Nz = (ABx * ACy) - (ABy * ACx);
-
-						/* Plane equation: Nx*x + Ny*y + Nz*z + d = 0. Plug in any point (in our case, [Ax, Ay, Az]) to find the value of d */
-						d = -(Nx*Ax + Ny*Ay + Nz*Az);
-
-						/* Find the value obtained when placing the camera's point onto the plane */
-						camX = currentSystem->planet[i]->radius*1.2*cos(camera->xAngle)*sin(camera->yAngle);
-						camY = -currentSystem->planet[i]->radius*1.2*cos(camera->yAngle);
-						camZ = -currentSystem->planet[i]->radius*1.2*sin(camera->xAngle)*sin(camera->yAngle);
-						value = Nx*camX + Ny*camY + Nz*camZ + d;
-
+					if(focusRow){
 						/* Save the largest value and track what row and column it was in */
+						value = section->normal.x*camX + section->normal.y*camY + section->normal.z*camZ + section->d;
 						if(largest < value){
 							largest = value;
-							camera->camC = c;
-							camera->camR = r;
+							camera->camC = c + 1;
+							camera->camR = r + 1;
 						}
 					}
 
-					/* Draw the surface's contents if there is a probe or satellite in orbit */
-					if(currentSystem->planet[i]->surface[r-1][c-1]->satellite >= 1 || currentSystem->planet[i]->surface[r-1][c-1]->probe >= 1){
-						drawSurfaceContents(i, r-1, c-1, Bx, By, Bz, Cx, Cy, Cz, Ax, Ay, Az);
+					/* Draw the surface's contents if there is a probe or satellite in orbit. Even columns are right side up triangles */
+					if(surface->satellite >= 1 || surface->probe >= 1){
+						if(c % 2 == 0){
+							drawSurfaceContents(i, r, c, section->A.x, section->A.y, section->A.z, section->C.x, section->C.y, section->C.z,
+									section->B.x, section->B.y, section->B.z);
+						}else{
+							drawSurfaceContents(i, r, c, section->B.x, section->B.y, section->B.z, section->C.x, section->C.y, section->C.z,
+									section->A.x, section->A.y, section->A.z);
+						}
 					}
 				}
-
-				/* switch between odd and even after each row change */
-				if(odd){
-					odd = 0;
-				}else{
-					odd = 1;
-				}
 			}
-			glEnd();
-
-			printf("____LARGEST VALUE___%d_%d\n", camera->camR, camera->camC);
 
-			/* Using what we found to be the currently selected row and column, use camJ and camK as indicators for the selected section
-			 * and get the appropriate values for ii and iii to specify the bouderies of the selected section*/
 			/* Ensure that there is a section that is selected - that the camera's position is neither above or bellow the selectable region */
 			if(camera->camC != -1 && camera->camR != -1){
-				r = 1;
-				for(ii = 0.15; r < camera->camR; gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1)){
-					r++;
-				}
-				c = 2;
-				/* Change the starting value depending on whether an upside down triangle is selected */
-				if(camera->camC % 2){
-					c--;
-				}
-				for(iii = 0; c < camera->camC; gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1)){
-					c++;
-					c++;
-				}
-
-				/* If the row is odd, insert an offset */
-				if(!(camera->camR % 2)){
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5);
-				}
-
-				/* Fill in the point values using the values of ii and iii as the selected sector values */
-				if(c % 2){
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.025000);
-					Ax = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					Ay = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Az = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.025000);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -0.025000);
-
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1 -0.025000);
-					Bx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					By = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Bz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -1 +0.025000);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -0.025000);
-
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1 -0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5);
-					Cx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					Cy = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Cz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.5);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -1 +0.025000);
-				}else{
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1.5 -0.025000);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1 -0.025000);
-					Ax = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					Ay = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Az = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -1 +0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -1.5 +0.025000);
-
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1 -0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5 +0.025000);
-					Bx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					By = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Bz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.5 -0.025000);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -1 +0.025000);
-
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, 0.025000);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1);
-					Cx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-					Cy = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-					Cz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -1);
-					gridIncrement(0, &ii, currentSystem->planet[i]->radius, -0.025000);
-				}
-
-//				/* Draw spheres on each point used to find the sections */
-//				glPushMatrix();
-//				glTranslatef(Ax, Ay, Az);
-//				glutWireSphere(0.25, 10, 10);
-//				glPopMatrix();
-//
-//				glPushMatrix();
-//				glTranslatef(Bx, By, Bz);
-//				glutWireSphere(0.25, 10, 10);
-//				glPopMatrix();
-//
-//				glPushMatrix();
-//				glTranslatef(Cx, Cy, Cz);
-//				glutWireSphere(0.25, 10, 10);
-//				glPopMatrix();
-
 				/* Draw the plane of the selected triangle and change the color and opacity of it */
+				section = &grid->section[(camera->camR - 1)*grid->columns + camera->camC - 1];
 				setColor(COLOR_SCAN_GRID_SELECTED);
 				glBegin(GL_TRIANGLES);
 				/* put the vertexes slightly closer to the planet so it does not cover up any other vertexes when selected */
-				glVertex3f(0.99*Ax, 0.99*Ay, 0.99*Az);
-				glVertex3f(0.99*Bx, 0.99*By, 0.99*Bz);
-				glVertex3f(0.99*Cx, 0.99*Cy, 0.99*Cz);
+				glVertex3f(0.99*section->A.x, 0.99*section->A.y, 0.99*section->A.z);
+				glVertex3f(0.99*section->B.x, 0.99*section->B.y, 0.99*section->B.z);
+				glVertex3f(0.99*section->C.x, 0.99*section->C.y, 0.99*section->C.z);
 				glEnd();
-
 			}
-//			/* Draw a sphere at where the camera is pointing */
-//			glPushMatrix();
-//			glTranslatef(camX, camY, camZ);
-//			glutWireSphere(0.25, 10, 10);
-//			glPopMatrix();
 		}
 
 		glColor3f(0.5, 0.0, 0.0);
@@ -1108,96 +1042,119 @@ void
 drawSystemBackground()
 {
 	/*
-	 * Draw the background of
+	 * Draw the background of the system view: a point for every other system and, when the camera is focused, the name,
+	 * distance and a line to each system within jumping range. The points and lines only change on a jump, so they are
+	 * drawn from display lists instead of being sent again every frame
 	 */
 	char output[NAME_LENGTH];
 	int close;
 	int i;
-	close = 0;
 
-	for(i = 0; i < SYSTEM_COUNT; i++){
-		/* Don't draw the current System as a point */
-		if(currentSystemIndex != i){
-			glColor3f(1, 1, 1);
-			glBegin(GL_POINTS);
-			glVertex3d(BGStars[i]->x - currentSystem->x, BGStars[i]->y - currentSystem->y, BGStars[i]->z - currentSystem->z);
-			glEnd();
-			if(systemDistanceArray[i] < player.jumpDistance){
-				close++;
-				if(selectedSystem > 0){
-					if(selectedSystem == close){
-						/* Draw the name of the system and distance*/
-						glColor4f(1, 1, 1, 1.0);
-						glRasterPos3f(BGStars[i]->x - currentSystem->x, BGStars[i]->y - currentSystem->y, BGStars[i]->z - currentSystem->z);
-						sprintf(output, "%s (%f)",systemArray[i]->name ,systemDistanceArray[i]);
-						drawString(output);
-
-						/* Draw a line from the origin to the system far away */
-						glColor4f(1, 1, 1, 0.5);
-						glBegin(GL_LINE_STRIP);
-						glVertex3d(0,0,0);
-						glVertex3d(BGStars[i]->x - currentSystem->x, BGStars[i]->y - currentSystem->y, BGStars[i]->z - currentSystem->z);
-						glEnd();
-					}
-				}else if(camera->focus == 1){
-					/* Draw the name of the system and distance*/
-					glColor4f(1, 1, 1, 1.0);
-					glRasterPos3f(BGStars[i]->x - currentSystem->x, BGStars[i]->y - currentSystem->y, BGStars[i]->z - currentSystem->z);
-					sprintf(output, "%s (%f)",systemArray[i]->name ,systemDistanceArray[i]);
-					drawString(output);
-
-					/* Draw a line from the origin to the system far away */
-					glColor4f(1, 1, 1, 0.1);
-					glBegin(GL_LINE_STRIP);
-					glVertex3d(0,0,0);
-					glVertex3d(BGStars[i]->x - currentSystem->x, BGStars[i]->y - currentSystem->y, BGStars[i]->z - currentSystem->z);
-					glEnd();
-				}
+	if(skyboxChanged){
+		buildSkybox();
+	}
+
+	glColor3f(1, 1, 1);
+	glCallList(skyboxList);
+
+	for(close = 0; close < nearbyCount; close++){
+		i = nearbyIndex[close];
+		if(selectedSystem > 0){
+			/* selectedSystem counts the nearby systems starting from 1 */
+			if(selectedSystem == close + 1){
+				/* Draw the name of the system and distance*/
+				glColor4f(1, 1, 1, 1.0);
+				glRasterPos3f(BGStars[i]->x - currentSystem->x, BGStars[i]->y - currentSystem->y, BGStars[i]->z - currentSystem->z);
+				sprintf(output, "%s (%f)",systemArray[i]->name ,systemDistanceArray[i]);
+				drawString(output);
+
+				/* Draw a line from the origin to the system far away */
+				glColor4f(1, 1, 1, 0.5);
+				glBegin(GL_LINE_STRIP);
+				glVertex3d(0,0,0);
+				glVertex3d(BGStars[i]->x - currentSystem->x, BGStars[i]->y - currentSystem->y, BGStars[i]->z - currentSystem->z);
+				glEnd();
 			}
+		}else if(camera->focus == 1){
+			/* Draw the name of the system and distance*/
+			glColor4f(1, 1, 1, 1.0);
+			glRasterPos3f(BGStars[i]->x - currentSystem->x, BGStars[i]->y - currentSystem->y, BGStars[i]->z - currentSystem->z);
+			sprintf(output, "%s (%f)",systemArray[i]->name ,systemDistanceArray[i]);
+			drawString(output);
 		}
 	}
+
+	/* Draw a line from the origin to every system within jumping range */
+	if(selectedSystem <= 0 && camera->focus == 1){
+		glColor4f(1, 1, 1, 0.1);
+		glCallList(skyboxList + 1);
+	}
+}
+
+void
+buildSkybox()
+{
+	/*
+	 * Compile the skybox's points and the jump lines to the nearby systems into their display lists.
+	 * Only the positions are compiled, so the color is set before each list is called
+	 */
+	int i;
+
+	if(skyboxList == 0){
+		skyboxList = glGenLists(2);
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, skyboxVertex);
+	glNewList(skyboxList, GL_COMPILE);
+	glDrawArrays(GL_POINTS, 0, skyboxCount);
+	glEndList();
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	glNewList(skyboxList + 1, GL_COMPILE);
+	glBegin(GL_LINES);
+	for(i = 0; i < nearbyCount; i++){
+		glVertex3d(0, 0, 0);
+		glVertex3d(BGStars[nearbyIndex[i]]->x - currentSystem->x, BGStars[nearbyIndex[i]]->y - currentSystem->y,
+				BGStars[nearbyIndex[i]]->z - currentSystem->z);
+	}
+	glEnd();
+	glEndList();
+
+	skyboxChanged = 0;
 }
 
 void
 drawOrbitLines()
 {
 	/*
-	 * Draw the orbit lines of the current system's planets
+	 * Draw the orbit lines of the current system's planets from the lines built when the system was loaded
 	 */
-	int i, ii;
+	int i;
 
+	glEnableClientState(GL_VERTEX_ARRAY);
 	for(i = 0; i < currentSystem->planetCount; i++){
+		/* Every orbit is drawn for the default view, and only the selected planet's orbit when the system is in focus */
+		if(camera->focus != 0 && (camera->focus != 1 || selectedAstronomicalObject != i + 2)){
+			continue;
+		}
+		if(selectedAstronomicalObject == i + 2){
+			glColor4f(1, 1, 1, 0.75);
+		}else if(selectedAstronomicalObject == 0){
+			glColor4f(1, 1, 1, 0.15);
+		}else {
+			glColor4f(1, 1, 1, 0.05);
+		}
+
 		/* Rotate the matrix to form the proper shape of the planet's orbit */
 		glPushMatrix();
 		glRotated(currentSystem->planet[i]->orbitOffset, 0.0, 1.0, 0.0);
 		glRotated(currentSystem->planet[i]->orbitTilt, 1.0, 0.0, 0.0);
-		if(camera->focus == 0){
-			glBegin(GL_LINE_STRIP);
-			if(selectedAstronomicalObject == i + 2){
-				glColor4f(1, 1, 1, 0.75);
-			}else if(selectedAstronomicalObject == 0){
-				glColor4f(1, 1, 1, 0.15);
-			}else {
-				glColor4f(1, 1, 1, 0.05);
-			}
-			for(ii = 0; ii < currentSystem->planet[i]->orbitRadius; ii++){
-				glVertex3d(currentSystem->planet[i]->orbitRadius*cos(2*M_PI*ii/currentSystem->planet[i]->orbitRadius), 0, currentSystem->planet[i]->orbitRadius*sin(2*M_PI*ii/currentSystem->planet[i]->orbitRadius));
-			}
-			glVertex3d(currentSystem->planet[i]->orbitRadius*cos(2*M_PI*0/currentSystem->planet[i]->orbitRadius), 0, currentSystem->planet[i]->orbitRadius*sin(2*M_PI*0/currentSystem->planet[i]->orbitRadius));
-			glEnd();
-		}else if(camera->focus == 1){
-			if(selectedAstronomicalObject == i + 2){
-				glColor4f(1, 1, 1, 0.75);
-				glBegin(GL_LINE_STRIP);
-				for(ii = 0; ii < currentSystem->planet[i]->orbitRadius; ii++){
-					glVertex3d(currentSystem->planet[i]->orbitRadius*cos(2*M_PI*ii/currentSystem->planet[i]->orbitRadius), 0, currentSystem->planet[i]->orbitRadius*sin(2*M_PI*ii/currentSystem->planet[i]->orbitRadius));
-				}
-				glVertex3d(currentSystem->planet[i]->orbitRadius*cos(2*M_PI*0/currentSystem->planet[i]->orbitRadius), 0, currentSystem->planet[i]->orbitRadius*sin(2*M_PI*0/currentSystem->planet[i]->orbitRadius));
-				glEnd();
-			}
-		}
+		glVertexPointer(3, GL_FLOAT, 0, currentSystem->orbit[i].vertex);
+		glDrawArrays(GL_LINE_LOOP, 0, currentSystem->orbit[i].segments);
 		glPopMatrix();
 	}
+	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 void
@@ -1345,60 +1302,39 @@ drawSatellites(int i)
 	 * It searches the entire planet's surface value for a satellite in motion (value between 0 and 1). The satellites path is found using a bezier
 	 * curve where it's path is completly relative to it's selection grid. The end point is the average of the three points comprising the plane
 	 */
-	double ii, iii, iiii;
+	double iiii;
 	double Ax ,Ay, Az, Bx, By, Bz, Cx, Cy, Cz;
 	int r, c;
 	double qx, qy, qz;
 	double b1, b2, b3, b4;
 	double p1x, p1y, p1z, p2x, p2y, p2z, p3x, p3y, p3z, p4x, p4y, p4z;
 	double dqx, dqy, dqz, db1, db2, db3, db4, n, ny, nz;
-	int odd = 0;
-	r = 0;
+	ScanGrid* grid = &currentSystem->scanGrid[i];
+	ScanSection* section;
+	Surface* surface;
 
-	for(ii = 0.15; ceil(ii*100000)/100000 < 0.35; gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1)){
-		c = 0;
-		for(iii = 0; ceil(iii*100000)/100000 < 1; gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1)){
+	for(r = 0; r < grid->rows; r++){
+		for(c = 0; c < grid->columns; c++){
 			/* Find all the surface values which currently have a satellite within the value {0, 1} */
-			/* Check this column and row's rightside up triangle for a satellite and a probe */
-			if(currentSystem->planet[i]->surface[r][c]->satellite > 0 || currentSystem->planet[i]->surface[r][c]->probe > 0){
-				/* Found a satellite in this selected grid and set the points that form it's plane */
-				if(odd){
-					/* If it's an odd row (1st from the bottom, 3rd from the bottom, etc) add an offset to the triangles */
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5);
-				}
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, 0.025000);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.025000);
-				Ax = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-				Ay = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-				Az = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.025000);
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, -0.025000);
-
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, 0.025000);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1 -0.025000);
-				Bx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-				By = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-				Bz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, -1 +0.025000);
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, -0.025000);
-
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1 -0.025000);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5);
-				Cx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-				Cy = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-				Cz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.5);
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, -1 +0.025000);
-				if(odd){
-					/* Revert the offset if there was one applied */
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.5);
-				}
+			surface = getSurface(currentSystem->planet[i], r, c);
+			if(surface->satellite > 0 || surface->probe > 0){
+				/* Found a satellite in this selected grid and get the points that form it's plane */
+				section = &grid->section[r*grid->columns + c];
+				Ax = section->A.x;
+				Ay = section->A.y;
+				Az = section->A.z;
+				Bx = section->B.x;
+				By = section->B.y;
+				Bz = section->B.z;
+				Cx = section->C.x;
+				Cy = section->C.y;
+				Cz = section->C.z;
 
 				/* normalize the 3 points forming the grid's plane */
 				n = sqrt(pow((Ax + Bx + Cx), 2) + pow((Ay + By + Cy), 2) + pow((Az + Bz + Cz), 2));
 
 				/* Draw the satellite on it's way to the planet's orbit if it's on it's way */
-				if(currentSystem->planet[i]->surface[r][c]->satellite > 0 && currentSystem->planet[i]->surface[r][c]->satellite < 1){
+				if(surface->satellite > 0 && surface->satellite < 1){
 					/* Set the bezier curve point's values */
 					//b1 is near the camera
 					p1x = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ax + Bx + Cx)/n);
@@ -1418,7 +1354,7 @@ drawSatellites(int i)
 					p4z = (Az + Bz + Cz)/3.0;
 
 					/* Find the satellite's position on the curve */
-					iiii = currentSystem->planet[i]->surface[r][c]->satellite;
+					iiii = surface->satellite;
 
 					b1 = pow((1-iiii), 3);
 					b2 = 3*iiii*pow((1-iiii), 2);
@@ -1456,7 +1392,7 @@ drawSatellites(int i)
 				}
 
 				/* Draw the probe on it's way to the planet's orbit if it's on it's way */
-				if(currentSystem->planet[i]->surface[r][c]->probe > 0 && currentSystem->planet[i]->surface[r][c]->probe < 1){
+				if(surface->probe > 0 && surface->probe < 1){
 					/* Set the bezier curve point's values */
 					//b1 is near the camera
 					p1x = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ax + Bx + Cx)/n);
@@ -1471,112 +1407,18 @@ drawSatellites(int i)
 					p3y = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((2*Ay + 2*By + 2*Cy)/n)*0.5;
 					p3z = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Az + Bz + Cz)/n)*0.5;
 					//b4 is at the center of the grid's plane.
-					p4x = currentSystem->planet[i]->radius*(Ax + Bx + Cx)/n;
-					p4y = currentSystem->planet[i]->radius*(Ay + By + Cy)/n;
-					p4z = currentSystem->planet[i]->radius*(Az + Bz + Cz)/n;
-
-					/* Find the satellite's position on the curve */
-					iiii = currentSystem->planet[i]->surface[r][c]->probe;
-
-					b1 = pow((1-iiii), 3);
-					b2 = 3*iiii*pow((1-iiii), 2);
-					b3 = 3*iiii*iiii*(1-iiii);
-					b4 = pow(iiii, 3);
-					qx = b1*p1x + b2*p2x + b3*p3x + b4*p4x;
-					qy = b1*p1y + b2*p2y + b3*p3y + b4*p4y;
-					qz = b1*p1z + b2*p2z + b3*p3z + b4*p4z;
-
-					/* Find the velocity of a point on the curve to rotate the satellite to face it's path */
-					db1 = -3*pow((iiii - 1), 2);
-					db2 = 3*(iiii-1)*(3*iiii-1);
-					db3 = 6*iiii - 9*pow(iiii, 2);
-					db4 = 3*pow(iiii, 2);
-					dqx = db1*p1x + db2*p2x + db3*p3x + db4*p4x;
-					dqy = db1*p1y + db2*p2y + db3*p3y + db4*p4y;
-					dqz = db1*p1z + db2*p2z + db3*p3z + db4*p4z;
-
-					/* normalize the vectors and commit the rotations */
-					ny = sqrt(pow(dqx, 2) + pow(dqy, 2) + pow(dqz, 2));
-					nz = sqrt(pow(dqx, 2) + pow(dqz, 2));
-					glPushMatrix();
-					glTranslated(qx, qy, qz);
-					glRotated(90, 0, 0, 1);
-					if((dqx/nz) < 0){
-						glRotated(90*asin(dqz/nz)/(M_PI/2), 1, 0, 0);
+					if(c % 2 == 0){
+						p4x = currentSystem->planet[i]->radius*(Ax + Bx + Cx)/n;
+						p4y = currentSystem->planet[i]->radius*(Ay + By + Cy)/n;
+						p4z = currentSystem->planet[i]->radius*(Az + Bz + Cz)/n;
 					}else{
-						glRotated(180 + 90*asin(-dqz/nz)/(M_PI/2), 1, 0, 0);
+						p4x = (Ax + Bx + Cx)/3.0;
+						p4y = (Ay + By + Cy)/3.0;
+						p4z = (Az + Bz + Cz)/3.0;
 					}
-					glRotated(-90*asin(dqy/ny)/(M_PI/2), 0, 0, 1);
-
-					/* Draw the satellite in the appropriate position along the path */
-					draw3DSatellite();
-					glPopMatrix();
-				}
-
-
-			}
-			c++;
-
-			/* Check this column and row's upside down triangle for satellites */
-			if(currentSystem->planet[i]->surface[r][c]->satellite > 0 || currentSystem->planet[i]->surface[r][c]->probe > 0){
-				/* Found a satellite in this selected grid and set the points that form it's plane */
-				if(odd){
-					/* If it's an odd row (1st from the bottom, 3rd from the bottom, etc) add an offset to the triangles */
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5);
-				}
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1.5 -0.025000);
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1 -0.025000);
-				Ax = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-				Ay = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-				Az = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, -1 +0.025000);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, -1.5 +0.025000);
-
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, 1 -0.025000);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, 0.5 +0.025000);
-				Bx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-				By = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-				Bz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.5 -0.025000);
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, -1 +0.025000);
-
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, 0.025000);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, 1);
-				Cx = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
-				Cy = currentSystem->planet[i]->radius*1.2*cos(ii*2*M_PI);
-				Cz = currentSystem->planet[i]->radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
-				gridIncrement(1, &iii, currentSystem->planet[i]->radius, -1);
-				gridIncrement(0, &ii, currentSystem->planet[i]->radius, -0.025000);
-				if(odd){
-					/* Revert the offset if there was one applied */
-					gridIncrement(1, &iii, currentSystem->planet[i]->radius, -0.5);
-				}
-
-				/* normalize the 3 points forming the grid's plane */
-				n = sqrt(pow((Ax + Bx + Cx), 2) + pow((Ay + By + Cy), 2) + pow((Az + Bz + Cz), 2));
-
-				/* Draw the satellite on it's way to the planet's orbit if it's on it's way */
-				if(currentSystem->planet[i]->surface[r][c]->satellite > 0 && currentSystem->planet[i]->surface[r][c]->satellite < 1){
-					/* Set the bezier curve point's values */
-					//b1 is near the camera
-					p1x = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ax + Bx + Cx)/n);
-					p1y = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ay + By + Cy)/n);
-					p1z = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Az + Bz + Cz)/n);
-					//b2 is one step from the camera. Use an arbitrary equation to add curves to the curve
-					p2x = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((-Az + -Bz + -Cz)/n)*0.2 + ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ax + Bx + Cx)/n)*0.6;
-					p2y = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ay + By + Cy)/n)*0.8;
-					p2z = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ax + Bx + Cx)/n)*0.2 + ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Az + Bz + Cz)/n)*0.6;
-					//b2 is one step from the grid's plane. Use an arbitrary equation to add curves to the curve
-					p3x = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Az + Bz + Cz)/n)*0.1 + ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ax + Bx + Cx)/n)*0.4;
-					p3y = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ay + By + Cy)/n)*0.5;
-					p3z = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((-Ax + -Bx + -Cx)/n)*0.1 + ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Az + Bz + Cz)/n)*0.4;
-					//b4 is at the center of the grid's plane.
-					p4x = (Ax + Bx + Cx)/3.0;
-					p4y = (Ay + By + Cy)/3.0;
-					p4z = (Az + Bz + Cz)/3.0;
 
 					/* Find the satellite's position on the curve */
-					iiii = currentSystem->planet[i]->surface[r][c]->satellite;
+					iiii = surface->probe;
 
 					b1 = pow((1-iiii), 3);
 					b2 = 3*iiii*pow((1-iiii), 2);
@@ -1612,73 +1454,7 @@ drawSatellites(int i)
 					draw3DSatellite();
 					glPopMatrix();
 				}
-
-				/* Draw the probe on it's way to the planet's orbit if it's on it's way */
-				if(currentSystem->planet[i]->surface[r][c]->probe > 0 && currentSystem->planet[i]->surface[r][c]->probe < 1){
-					/* Set the bezier curve point's values */
-					//b1 is near the camera
-					p1x = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ax + Bx + Cx)/n);
-					p1y = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ay + By + Cy)/n);
-					p1z = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Az + Bz + Cz)/n);
-					//b2 is one step from the camera. Use an arbitrary equation to add curves to the curve
-					p2x = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ax + Bx + Cx)/n)*0.8;
-					p2y = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ay + By + Cy)/n)*0.8;
-					p2z = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Az + Bz + Cz)/n)*0.8;
-					//b2 is one step from the grid's plane. Use an arbitrary equation to add curves to the curve
-					p3x = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Ax + Bx + Cx)/n)*0.5;
-					p3y = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((2*Ay + 2*By + 2*Cy)/n)*0.5;
-					p3z = ((2 + currentSystem->planet[i]->radius/4.0)*7.5)*((Az + Bz + Cz)/n)*0.5;
-					//b4 is at the center of the grid's plane.
-					p4x = (Ax + Bx + Cx)/3.0;
-					p4y = (Ay + By + Cy)/3.0;
-					p4z = (Az + Bz + Cz)/3.0;
-
-					/* Find the satellite's position on the curve */
-					iiii = currentSystem->planet[i]->surface[r][c]->probe;
-
-					b1 = pow((1-iiii), 3);
-					b2 = 3*iiii*pow((1-iiii), 2);
-					b3 = 3*iiii*iiii*(1-iiii);
-					b4 = pow(iiii, 3);
-					qx = b1*p1x + b2*p2x + b3*p3x + b4*p4x;
-					qy = b1*p1y + b2*p2y + b3*p3y + b4*p4y;
-					qz = b1*p1z + b2*p2z + b3*p3z + b4*p4z;
-
-					/* Find the velocity of a point on the curve to rotate the probe to face it's path */
-					db1 = -3*pow((iiii - 1), 2);
-					db2 = 3*(iiii-1)*(3*iiii-1);
-					db3 = 6*iiii - 9*pow(iiii, 2);
-					db4 = 3*pow(iiii, 2);
-					dqx = db1*p1x + db2*p2x + db3*p3x + db4*p4x;
-					dqy = db1*p1y + db2*p2y + db3*p3y + db4*p4y;
-					dqz = db1*p1z + db2*p2z + db3*p3z + db4*p4z;
-
-					/* normalize the vectors and commit the rotations */
-					ny = sqrt(pow(dqx, 2) + pow(dqy, 2) + pow(dqz, 2));
-					nz = sqrt(pow(dqx, 2) + pow(dqz, 2));
-					glPushMatrix();
-					glTranslated(qx, qy, qz);
-					glRotated(90, 0, 0, 1);
-					if((dqx/nz) < 0){
-						glRotated(90*asin(dqz/nz)/(M_PI/2), 1, 0, 0);
-					}else{
-						glRotated(180 + 90*asin(-dqz/nz)/(M_PI/2), 1, 0, 0);
-					}
-					glRotated(-90*asin(dqy/ny)/(M_PI/2), 0, 0, 1);
-
-					/* Draw the probe in the appropriate position along the path */
-					draw3DSatellite();
-					glPopMatrix();
-				}
 			}
-			c++;
-		}
-		r++;
-		/* switch between odd and even after each row change */
-		if(odd){
-			odd = 0;
-		}else{
-			odd = 1;
 		}
 	}
 
@@ -1722,11 +1498,11 @@ drawSurfaceContents(int i, int r, int c, double leftX, double leftY, double left
 	 */
 	double TL[3], TR[3], BL[3], BR[3];
 
-	if(currentSystem->planet[i]->surface[r][c]->satellite >= 1){
+	if(getSurface(currentSystem->planet[i], r, c)->satellite >= 1){
 		/* Draw an energy icon if the surface's energy is less than or equal to the user's energy limit */
-		if(currentSystem->planet[i]->surface[r][c]->energy <= energyLimit){
+		if(getSurface(currentSystem->planet[i], r, c)->energy <= energyLimit){
 			/* Set the color for the energy icon */
-			if(currentSystem->planet[i]->surface[r][c]->probe >= 1){
+			if(getSurface(currentSystem->planet[i], r, c)->probe >= 1){
 				/* Draw the energy icon with its correct color */
 				setColor(COLOR_ENERGY);
 			}else{
@@ -1850,9 +1626,9 @@ drawSurfaceContents(int i, int r, int c, double leftX, double leftY, double left
 		}
 
 		/* Draw a mineral icon if the surface's mineral output is less than or equal to the user's mineral limit */
-		if(currentSystem->planet[i]->surface[r][c]->mineral <= mineralLimit){
+		if(getSurface(currentSystem->planet[i], r, c)->mineral <= mineralLimit){
 			/* Set the color for the mineral icon */
-			if(currentSystem->planet[i]->surface[r][c]->probe >= 1){
+			if(getSurface(currentSystem->planet[i], r, c)->probe >= 1){
 				/* Draw the energy icon with its correct color */
 				setColor(COLOR_MINERAL);
 			}else{
@@ -1996,7 +1772,7 @@ drawSurfaceContents(int i, int r, int c, double leftX, double leftY, double left
 		}
 
 	}else{
-		if(currentSystem->planet[i]->surface[r][c]->probe >= 1){
+		if(getSurface(currentSystem->planet[i], r, c)->probe >= 1){
 			/*
 			 * Draw a question mark
 			 */
@@ -2573,86 +2349,30 @@ void
 updateSatellitePath(int increment)
 {
 /*
- * Increment the value of all of the current planet's satellites. This is run on each timer update and when the system changes.
+ * Increment the value of all of the current system's satellites. This is run on each timer update and when the system changes.
  *
  * On each timer update (increment = 0), it increments the satellites values by a small amount. When leave the scanning menu option
- * (increment = 1), all satellites' values are set to 1 to instantly enter orbit so we don't have to track and increment the
- * values of satellites outside the system. Sattelites included are satellites and probes.
+ * (increment = 1), all satellites' values are set to 1 to instantly enter orbit. Sattelites included are satellites and probes.
+ * Only the launches in the launchList are visited, and each one is removed from the list once it reaches orbit.
  */
-	int r, c;
-	double i, ii;
-
-	/* Ensure that the camera has a planet currently selected */
-	if(selectedAstronomicalObject - 2 >= 0){
-		/* Sort through the selected planet's rows and columns to visit every surface section. This might need to be changed to allow tracking
-		 * which specific sections has a satallite on its way to orbit using a linked list to not require visiting all 2D array entries */
-		r = 0;
-		for(i = 0.15; ceil(i*100000)/100000 < 0.35; gridIncrement(0, &i, currentSystem->planet[selectedAstronomicalObject - 2]->radius, 1)){
-			c = 0;
-			for(ii = 0; ceil(ii*100000)/100000 < 1; gridIncrement(1, &ii, currentSystem->planet[selectedAstronomicalObject - 2]->radius, 1)){
-				/* Check to see if there is currently a satellite on a path to this surface section (right side up triangle) */
-				if(currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite > 0 &&
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite < 1){
-					if(increment == 0){
-						/* Slowly increment the value of the current system's satellites. This should be changed to track what satellites */
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite += 0.01;
-						if(!(currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite < 1)){
-							currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite = 1;
-						}
-					}else if(increment == 1){
-						/* Instantly place the planet's satellites into orbit */
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite = 1;
-					}
-				}
+	int i;
 
-				/* Check to see if there is currently a probe on a path to this surface section (right side up triangle) */
-				if(currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe > 0 &&
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe < 1){
-					if(increment == 0){
-						/* Slowly increment the value of the current system's satellites. This should be changed to track what satellites */
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe += 0.01;
-						if(!(currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe < 1)){
-							currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe = 1;
-						}
-					}else if(increment == 1){
-						/* Instantly place the planet's probes into orbit */
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe = 1;
-					}
-				}
-				c++;
-
-				/* Check to see if there is currently a satellite on a path to this surface section (upside down triangle) */
-				if(currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite > 0 &&
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite < 1){
-					if(increment == 0){
-						/* Slowly increment the value of the current system's satellites. This should be changed to track what satellites */
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite += 0.01;
-						if(!(currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite < 1)){
-							currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite = 1;
-						}
-					}else if(increment == 1){
-						/* Instantly place the planet's satellites into orbit */
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->satellite = 1;
-					}
-				}
+	i = 0;
+	while(i < launchCount){
+		if(increment == 0){
+			/* Slowly increment the value of the current system's satellites */
+			*launchList[i] += 0.01;
+		}else if(increment == 1){
+			/* Instantly place the satellite into orbit */
+			*launchList[i] = 1;
+		}
 
-				/* Check to see if there is currently a probe on a path to this surface section (upside down triangle) */
-				if(currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe > 0 &&
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe < 1){
-					if(increment == 0){
-						/* Slowly increment the value of the current system's satellites. This should be changed to track what satellites */
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe += 0.01;
-						if(!(currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe < 1)){
-							currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe = 1;
-						}
-					}else if(increment == 1){
-						/* Instantly place the planet's probe into orbit */
-						currentSystem->planet[selectedAstronomicalObject - 2]->surface[r][c]->probe = 1;
-					}
-				}
-				c++;
-			}
-		r++;
+		if(!(*launchList[i] < 1)){
+			/* The satellite reached orbit. Replace it with the last launch in the list */
+			*launchList[i] = 1;
+			launchList[i] = launchList[--launchCount];
+		}else{
+			i++;
 		}
 	}
 }
@@ -2692,7 +2412,7 @@ updateWindow()
 		windowState += 0.01;
 	}else if(windowState < 4){
 		/* Start incrementing at wierd intervals to simulate lag */
-		randomIncrement = myRandom(0, 1);
+		randomIncrement = effectRandom(0, 1);
 		if(randomIncrement > 0.55){
 			windowState += randomIncrement*0.025;
 		}
@@ -2704,7 +2424,7 @@ updateWindow()
 		windowState += 0.01;
 	}else if(windowState < 5){
 		/* Increment at a very laggy pace. During this time, change the background to static before reaching past a windowState of 5 */
-		randomIncrement = myRandom(0, 1);
+		randomIncrement = effectRandom(0, 1);
 		if(randomIncrement > 0.95){
 			windowState += randomIncrement*0.025;
 		}
@@ -2743,80 +2463,85 @@ randomSystem()
 	 * There is a randomly selected planet in the system which will be a ringed planet
 	 */
 	int i, ii, r, c, planetCount, rows, columns;
-	double iii, iiii;
 	char systemName[NAME_LENGTH];
 	SystemStar newStar;
-	FILE* savefile = fopen("savefile","w+");
+	SaveHeader header;
+	SaveIndex index;
+	FILE* savefile;
+
+	/* The savefile is about to be replaced, so it can not stay mapped */
+	unmapSavefile();
+	savefile = fopen(SAVEFILE_NAME, "w+b");
+
+	/* Write the header and skip past the index table, which is filled in as each system is written */
+	memcpy(header.magic, SAVEFILE_MAGIC, 4);
+	header.version = SAVEFILE_VERSION;
+	header.systemCount = SYSTEM_COUNT;
+	header.currentSystemIndex = 0;
+	header.seed = randomSeed;
+	header.reserved = 0;
+	fwrite(&header, sizeof(SaveHeader), 1, savefile);
+	fseek(savefile, sizeof(SaveHeader) + sizeof(SaveIndex)*SYSTEM_COUNT, SEEK_SET);
 
 	for(i = 0; i < SYSTEM_COUNT; i++){
 		// Names for astranomical objects can have all letters, numbers, white spaces and dashes (NO COMAS!)
 		strcpy(systemName, "SystemName");
-		planetCount = myRandom(1, 10);
+		planetCount = universeRandom(1, 10);
 		//newPlanetArray = malloc(sizeof(SystemPlanet*)*planetCount);
 		strcpy(systemArray[i]->name, systemName);
 		systemArray[i]->planetCount = planetCount;
-		systemArray[i]->x = myRandom(-100, 100);
-		systemArray[i]->y = myRandom(-100, 100);
-		systemArray[i]->z = myRandom(-100, 100);
-		/* Save the system's stats */
-		fprintf(savefile, "[%d] %s, %f, %f, %f, %d\n", i, systemArray[i]->name, systemArray[i]->x, systemArray[i]->y, systemArray[i]->z, systemArray[i]->planetCount);
+		systemArray[i]->x = universeRandom(-100, 100);
+		systemArray[i]->y = universeRandom(-100, 100);
+		systemArray[i]->z = universeRandom(-100, 100);
+		/* The system's stats are saved in it's index entry, while it's block starts here */
+		index.offset = ftell(savefile);
+		index.system = *systemArray[i];
 		/* Generate the systems star */
 		strcpy(newStar.name, "new Star");
-		newStar.radius = myRandom(60, 100);
+		newStar.radius = universeRandom(60, 100);
 		newStar.orbitRadius = 0;
 		newStar.axialTilt = 0;
 		newStar.orbitTilt = 0;
 		newStar.orbitOffset = 0;
 		newStar.dayOffset = 0;
 		newStar.yearOffset = 0;
-		newStar.daySpeed = myRandom(0.001, 0.0001);
+		newStar.daySpeed = universeRandom(0.001, 0.0001);
 		newStar.yearSpeed = 0;
 		/* save the star's stats */
-		fprintf(savefile, "%s, %f, %f, %f, %f, %f, %f, %f, %f, %f\n", newStar.name, newStar.radius, newStar.orbitRadius, newStar.axialTilt,
-				newStar.orbitTilt, newStar.orbitOffset, newStar.dayOffset, newStar.yearOffset, newStar.daySpeed, newStar.yearSpeed);
+		fwrite(&newStar, sizeof(SystemStar), 1, savefile);
 
 		/* Genetrate the systems planets */
 		SystemPlanet newPlanetArray[planetCount];
 		for(ii = 0; ii < planetCount; ii++){
 			strcpy(newPlanetArray[ii].name, "new Planet");
-			newPlanetArray[ii].radius = myRandom(3, 20);
+			newPlanetArray[ii].radius = universeRandom(3, 20);
 			/* Keep the radius from having more than 3 decimal point values */
 			newPlanetArray[ii].radius = ceil(newPlanetArray[ii].radius*1000)/1000.0;
 			//Prevent the planets from clipping into eachother
 			if(ii > 0){
-				newPlanetArray[ii].orbitRadius = newPlanetArray[ii-1].orbitRadius + newPlanetArray[ii-1].radius/2.0 + newPlanetArray[ii].radius/2.0 + myRandom(30, 100);
+				newPlanetArray[ii].orbitRadius = newPlanetArray[ii-1].orbitRadius + newPlanetArray[ii-1].radius/2.0 + newPlanetArray[ii].radius/2.0 + universeRandom(30, 100);
 			}else{
-				newPlanetArray[ii].orbitRadius = newStar.radius + myRandom(30, 100);
+				newPlanetArray[ii].orbitRadius = newStar.radius + universeRandom(30, 100);
 			}
-			newPlanetArray[ii].type = myRandom(0, 1);
-			newPlanetArray[ii].axialTilt = myRandom(0, 180);
-			newPlanetArray[ii].orbitTilt = myRandom(-30, 30);
-			newPlanetArray[ii].orbitOffset = myRandom(-30, 30);
-			newPlanetArray[ii].dayOffset = myRandom(0.0, 1.0);
-			newPlanetArray[ii].yearOffset = myRandom(0.0, 1.0);
-			newPlanetArray[ii].daySpeed = myRandom(0.001, 0.0001);
-			newPlanetArray[ii].yearSpeed = ceil((myRandom(0.05, 0.01)/newPlanetArray[ii].orbitRadius)*100000)/100000;
+			newPlanetArray[ii].type = universeRandom(0, 1);
+			newPlanetArray[ii].axialTilt = universeRandom(0, 180);
+			newPlanetArray[ii].orbitTilt = universeRandom(-30, 30);
+			newPlanetArray[ii].orbitOffset = universeRandom(-30, 30);
+			newPlanetArray[ii].dayOffset = universeRandom(0.0, 1.0);
+			newPlanetArray[ii].yearOffset = universeRandom(0.0, 1.0);
+			newPlanetArray[ii].daySpeed = universeRandom(0.001, 0.0001);
+			newPlanetArray[ii].yearSpeed = ceil((universeRandom(0.05, 0.01)/newPlanetArray[ii].orbitRadius)*100000)/100000;
 
 
 			/* Initialize the planet's surface stats and set default values */
-			/* Find how many rows can fit on this planet's surface */
-			rows = 0;
-			for(iii = 0.15; ceil(iii*100000)/100000 < 0.35; gridIncrement(0, &iii, newPlanetArray[ii].radius, 1)){
-				rows++;
-			}
-			/* Find out how many columns can fit on this planet's surface. Remember that each column has two section triangles */
-			columns = 0;
-			for(iiii = 0.0; ceil(iiii*100000)/100000 < 1.0; gridIncrement(1, &iiii, newPlanetArray[ii].radius, 1)){
-				columns++;
-				columns++;
-			}
+			/* Find how many rows and columns can fit on this planet's surface */
+			scanGridSize(newPlanetArray[ii].radius, &rows, &columns);
 			newPlanetArray[ii].surfaceRows = rows;
 			newPlanetArray[ii].surfaceColumns = columns;
+			newPlanetArray[ii].surface = NULL;
 
 			/* Save the planet's values */
-			fprintf(savefile, "{%d, %d}, %s, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f\n", rows, columns, newPlanetArray[ii].name, newPlanetArray[ii].radius,
-					newPlanetArray[ii].type, newPlanetArray[ii].orbitRadius, newPlanetArray[ii].axialTilt, newPlanetArray[ii].orbitTilt, newPlanetArray[ii].orbitOffset,
-					newPlanetArray[ii].dayOffset, newPlanetArray[ii].yearOffset, newPlanetArray[ii].daySpeed, newPlanetArray[ii].yearSpeed);
+			fwrite(&newPlanetArray[ii], sizeof(SystemPlanet), 1, savefile);
 
 			/* Initilize the surfaceArray */
 			Surface planetSurface[rows][columns];
@@ -2826,21 +2551,20 @@ randomSystem()
 					/* Assign values to the planet's surfaces */
 					planetSurface[r][c].satellite = 0;
 					planetSurface[r][c].probe = 0;
-					planetSurface[r][c].energy = myRandom(0, 1);
-					planetSurface[r][c].mineral = myRandom(0, 1);
-					/* Save the surface's values */
-					fprintf(savefile, "(%d, %d), %f, %f, %f, %f ", r, c, planetSurface[r][c].satellite,
-							planetSurface[r][c].probe, planetSurface[r][c].energy,
-							planetSurface[r][c].mineral);
+					planetSurface[r][c].energy = universeRandom(0, 1);
+					planetSurface[r][c].mineral = universeRandom(0, 1);
 				}
-				fprintf(savefile, "\n");
 			}
+			/* Save the surface's values */
+			fwrite(planetSurface, sizeof(Surface), rows*columns, savefile);
 		}
+
+		/* Point the system's index entry to the block that was just written */
+		writeSaveIndex(savefile, i, &index);
 	}
 
-	/* Set a currentSystemIndex for the user to start in and add it to the save file */
+	/* Set a currentSystemIndex for the user to start in. It was already added to the header */
 	currentSystemIndex = 0;
-	fprintf(savefile, "[%d]\n", currentSystemIndex);
 
 	/* Close the file to save it's values. It needs to be opened again to re-access it's values */
 	fclose(savefile);
@@ -2852,9 +2576,9 @@ randomSystem()
 
 	/* Set the currently selected planet to be a ringed planet in the current system and save the changed value */
 	int startingPlanet;
-	startingPlanet = ceil(myRandom(0, currentSystem->planetCount-1));
+	startingPlanet = ceil(universeRandom(0, currentSystem->planetCount-1));
 	selectedAstronomicalObject = (int) (startingPlanet) + 2;
-//	currentSystem->planet[selectedAstronomicalObject - 2]->type = myRandom(PLANET_TYPE_COLONIZED_LIMIT, PLANET_TYPE_RING_LIMIT);
+//	currentSystem->planet[selectedAstronomicalObject - 2]->type = universeRandom(PLANET_TYPE_COLONIZED_LIMIT, PLANET_TYPE_RING_LIMIT);
 	currentSystem->planet[selectedAstronomicalObject - 2]->type = PLANET_TYPE_COLONIZED_LIMIT;
 	printf("start saving\n");
 	saveSystem();
@@ -2903,6 +2627,26 @@ calculateBackgroundStars()
 		}
 		systemDistanceArray[i] = distance;
 	}
+
+	/* Save the skybox's points and the nearby systems. The current system is not drawn as a point */
+	if(skyboxVertex == NULL){
+		skyboxVertex = malloc(sizeof(GLfloat)*3*SYSTEM_COUNT);
+		nearbyIndex = malloc(sizeof(int)*SYSTEM_COUNT);
+	}
+	skyboxCount = 0;
+	nearbyCount = 0;
+	for(i = 0; i < SYSTEM_COUNT; i++){
+		if(currentSystemIndex != i){
+			skyboxVertex[skyboxCount*3 + 0] = BGStars[i]->x - currentSystem->x;
+			skyboxVertex[skyboxCount*3 + 1] = BGStars[i]->y - currentSystem->y;
+			skyboxVertex[skyboxCount*3 + 2] = BGStars[i]->z - currentSystem->z;
+			skyboxCount++;
+			if(systemDistanceArray[i] < player.jumpDistance){
+				nearbyIndex[nearbyCount++] = i;
+			}
+		}
+	}
+	skyboxChanged = 1;
 }
 
 void
@@ -3058,6 +2802,135 @@ gridIncrement(int incrementor, double* value, double radius, double multiplier)
 	}
 }
 
+void
+scanGridSize(double radius, int* rows, int* columns)
+{
+	/*
+	 * Find how many rows and columns of the scanning grid fit on a planet with the given radius.
+	 * Remember that each column has two section triangles
+	 */
+	double ii;
+
+	*rows = 0;
+	for(ii = 0.15; ceil(ii*100000)/100000 < 0.35; gridIncrement(0, &ii, radius, 1)){
+		(*rows)++;
+	}
+	*columns = 0;
+	for(ii = 0.0; ceil(ii*100000)/100000 < 1.0; gridIncrement(1, &ii, radius, 1)){
+		*columns += 2;
+	}
+}
+
+void
+scanGridPoint(Point* point, double radius, double ii, double iii, double rowMultiplier, double columnMultiplier)
+{
+	/*
+	 * Find a point of the scanning grid. The given row (ii) and column (iii) values are pushed by the multipliers
+	 * using gridIncrement and then placed onto a sphere slightly larger than the planet
+	 */
+	gridIncrement(0, &ii, radius, rowMultiplier);
+	gridIncrement(1, &iii, radius, columnMultiplier);
+	point->x = radius*1.2*sin(ii*2*M_PI)*cos(iii*2*M_PI);
+	point->y = radius*1.2*cos(ii*2*M_PI);
+	point->z = radius*1.2*sin(ii*2*M_PI)*sin(iii*2*M_PI);
+}
+
+void
+buildScanGrid(SystemPlanet* planet, ScanGrid* grid)
+{
+	/*
+	 * Fill the given grid with every section of the planet's scanning grid. The grid is formed of two triangle types: one points up and
+	 * the other points down. There are equal amounts of both and always begin with the right-side up. Odd rows (1st from the bottom,
+	 * 3rd from the bottom, etc) are offset by half a column. The ii value determines the rows from the top to bottom of the planet, where
+	 * 0.0 is at the bottom and 0.5 is at the top. The iii value determines the width of the columns around the sphere.
+	 */
+	int r, c, odd;
+	double ii, iii, offset;
+	Point AB, AC;
+	ScanSection* section;
+
+	odd = 0;
+	r = 0;
+	for(ii = 0.15; ceil(ii*100000)/100000 < 0.35 && r < grid->rows; gridIncrement(0, &ii, planet->radius, 1)){
+		/* Find the height of the row's top and bottom edges */
+		grid->rowTop[r] = planet->radius*1.2*cos(ii*2*M_PI);
+		scanGridPoint(&AB, planet->radius, ii, 0, 1, 0);
+		grid->rowBottom[r] = AB.y;
+
+		offset = odd ? 0.5 : 0;
+		c = 0;
+		for(iii = 0; ceil(iii*100000)/100000 < 1 && c < grid->columns; gridIncrement(1, &iii, planet->radius, 1)){
+			/* Right side up triangle */
+			section = &grid->section[r*grid->columns + c];
+			scanGridPoint(&section->A, planet->radius, ii, iii, 0.025, offset + 0.025);
+			scanGridPoint(&section->B, planet->radius, ii, iii, 0.025, offset + 1 - 0.025);
+			scanGridPoint(&section->C, planet->radius, ii, iii, 1 - 0.025, offset + 0.5);
+			c++;
+
+			/* Upside down triangle */
+			section++;
+			scanGridPoint(&section->A, planet->radius, ii, iii, 1 - 0.025, offset + 1.5 - 0.025);
+			scanGridPoint(&section->B, planet->radius, ii, iii, 1 - 0.025, offset + 0.5 + 0.025);
+			scanGridPoint(&section->C, planet->radius, ii, iii, 0.025, offset + 1);
+			c++;
+		}
+
+		/* switch between odd and even after each row change */
+		odd = !odd;
+		r++;
+	}
+
+	/* Use the cross product of two of each section's edges to find the normal vector of it's plane, then plug in
+	 * any point (in our case, A) to find the value of d */
+	for(c = 0; c < grid->rows*grid->columns; c++){
+		section = &grid->section[c];
+		AB.x = section->B.x - section->A.x;
+		AB.y = section->B.y - section->A.y;
+		AB.z = section->B.z - section->A.z;
+		AC.x = section->C.x - section->A.x;
+		AC.y = section->C.y - section->A.y;
+		AC.z = section->C.z - section->A.z;
+		section->normal.x = (AB.y * AC.z) - (AB.z * AC.y);
+		section->normal.y = (AB.z * AC.x) - (AB.x * AC.z);
+		section->normal.z = (AB.x * AC.y) - (AB.y * AC.x);
+		section->d = -(section->normal.x*section->A.x + section->normal.y*section->A.y + section->normal.z*section->A.z);
+	}
+}
+
+int
+orbitSegments(SystemPlanet* planet)
+{
+	/*
+	 * Find the amount of segments the planet's orbit line needs. A segment of a circle of radius r spanning 2*PI/n strays
+	 * r*(1 - cos(PI/n)) from the circle, which is kept under ORBIT_LINE_ERROR of the focused planet camera's distance
+	 */
+	double distance;
+	int segments;
+
+	distance = (2 + planet->radius/4.0)*7.5;
+	segments = ceil(M_PI/acos(1 - ORBIT_LINE_ERROR*distance/planet->orbitRadius));
+	if(segments < ORBIT_LINE_MIN_SEGMENTS){
+		segments = ORBIT_LINE_MIN_SEGMENTS;
+	}
+
+	return segments;
+}
+
+void
+buildOrbitLine(SystemPlanet* planet, OrbitLine* orbit)
+{
+	/*
+	 * Fill the given orbit line with the points of the planet's orbit around the star on the orbit's plane
+	 */
+	int i;
+
+	for(i = 0; i < orbit->segments; i++){
+		orbit->vertex[i*3 + 0] = planet->orbitRadius*cos(2*M_PI*i/orbit->segments);
+		orbit->vertex[i*3 + 1] = 0;
+		orbit->vertex[i*3 + 2] = planet->orbitRadius*sin(2*M_PI*i/orbit->segments);
+	}
+}
+
 void
 systemLaunchSatellite(int i)
 {
@@ -3075,25 +2948,41 @@ systemLaunchSatellite(int i)
 	}else{
 		if(i == 0){
 			/* Launch satellite option selected */
-			if(currentSystem->planet[selectedAstronomicalObject - 2]->surface[camera->camR - 1][camera->camC - 1]->satellite > 0){
+			if(getSurface(currentSystem->planet[selectedAstronomicalObject - 2], camera->camR - 1, camera->camC - 1)->satellite > 0){
 				printf("There is already a satellite in orbit here\n");
 			}else{
 				printf("Sent a satellite into orbit\n");
-				currentSystem->planet[selectedAstronomicalObject - 2]->surface[camera->camR - 1][camera->camC - 1]->satellite = 0.01;
+				getSurface(currentSystem->planet[selectedAstronomicalObject - 2], camera->camR - 1, camera->camC - 1)->satellite = 0.01;
+				addLaunch(&getSurface(currentSystem->planet[selectedAstronomicalObject - 2], camera->camR - 1, camera->camC - 1)->satellite);
 			}
 		}else if(i == 1){
 			/* Launch probe option selected */
-			if(currentSystem->planet[selectedAstronomicalObject - 2]->surface[camera->camR - 1][camera->camC - 1]->probe > 0){
+			if(getSurface(currentSystem->planet[selectedAstronomicalObject - 2], camera->camR - 1, camera->camC - 1)->probe > 0){
 				printf("There is already a probe in orbit here\n");
 			}else{
 				printf("Sent a probe into orbit\n");
-				currentSystem->planet[selectedAstronomicalObject - 2]->surface[camera->camR - 1][camera->camC - 1]->probe = 0.01;
+				getSurface(currentSystem->planet[selectedAstronomicalObject - 2], camera->camR - 1, camera->camC - 1)->probe = 0.01;
+				addLaunch(&getSurface(currentSystem->planet[selectedAstronomicalObject - 2], camera->camR - 1, camera->camC - 1)->probe);
 			}
 		}
 		printf("_%d_%d_",camera->camR, camera->camC);
 	}
 }
 
+void
+addLaunch(double* path)
+{
+	/*
+	 * Add a satellite or probe that is on it's way to orbit to the launchList, growing the list if it is full.
+	 * The given path is the surface's satellite or probe value
+	 */
+	if(launchCount == launchCapacity){
+		launchCapacity = launchCapacity ? launchCapacity*2 : 16;
+		launchList = realloc(launchList, sizeof(double*)*launchCapacity);
+	}
+	launchList[launchCount++] = path;
+}
+
 void
 setColor(int colorID)
 {
@@ -3206,192 +3095,312 @@ saveSystem()
 {
 	/*
 	 * Save the current system's values into the save file. This should be run on program close and system change.
-	 * The process of this is to read in the original savefile into a buffer. It is sent to a new temp file unless it
-	 * is the current system, which is where it's new values will be added instead of the saved values. The rest of the file
-	 * is sent into the buffer and the temp file is now the new savefile, removing the previous one.
+	 * The star and surfaces already live in the mapped savefile, so only the planet records that changed and the
+	 * currentSystemIndex in the header are written, then the changed pages are scheduled to be written to disk.
 	 */
-	int i, ii, iii, pos;
-	FILE* saveStream = fopen("savefile", "r+");
-
-	/* Cycle through the savefile looking for the starting position for the given system index */
-	fseek(saveStream, 0, SEEK_SET);
-	pos = -1;
-
-	while(pos != currentSystemIndex){
-		/* Scan the current line assuming it is a system line and fetch the index */
-		fscanf(saveStream, "[%d]", &pos);
-		if(pos != currentSystemIndex){
-			/* Push the stream pointer to the next line */
-			fscanf(saveStream, "%*[^\n]%*c");
-		}
+	int i;
+	char* block;
+	SaveHeader* header;
+	SaveIndex* index;
+	SystemPlanet planet;
+
+	if(currentSystem == NULL || !mapSavefile()){
+		return;
 	}
+	header = (SaveHeader*) saveMap;
+	index = (SaveIndex*) (saveMap + sizeof(SaveHeader)) + currentSystemIndex;
 
-	/* The stream's pointer position is currently on the systems value line. Skip past the rest of it and the star to reach the planet's surfaces */
-	fscanf(saveStream, "%*[^\n]%*c");
-	fscanf(saveStream, "%*[^\n]%*c");
+	/* Skip past the star to reach the first planet's record */
+	block = saveMap + index->offset + sizeof(SystemStar);
 
 	for(i = 0; i < currentSystem->planetCount; i++){
-		/* Update the planet's stats to follow along with the surface values */
-		fseek(saveStream, 0, SEEK_CUR);
-		if(fprintf(saveStream, "{%d, %d}, %s, %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf\n", currentSystem->planet[i]->surfaceRows, currentSystem->planet[i]->surfaceColumns,
-				currentSystem->planet[i]->name, currentSystem->planet[i]->radius, currentSystem->planet[i]->type, currentSystem->planet[i]->orbitRadius,
-				currentSystem->planet[i]->axialTilt, currentSystem->planet[i]->orbitTilt, currentSystem->planet[i]->orbitOffset, currentSystem->planet[i]->dayOffset,
-				currentSystem->planet[i]->yearOffset, currentSystem->planet[i]->daySpeed, currentSystem->planet[i]->yearSpeed) < 0){
-			printf("ERROR SAVING PLANET VALUES\n");
+		/* Update the planet's stats. The surface pointer is not saved. Leave the record alone if nothing changed so it's page stays clean */
+		memcpy(&planet, currentSystem->planet[i], sizeof(SystemPlanet));
+		planet.surface = NULL;
+		if(memcmp(block, &planet, sizeof(SystemPlanet)) != 0){
+			memcpy(block, &planet, sizeof(SystemPlanet));
 		}
 
-		for(ii = 0; ii < currentSystem->planet[i]->surfaceRows; ii++){
-			for(iii = 0; iii < currentSystem->planet[i]->surfaceColumns; iii++){
-				/* Update the surface values */
-				fseek(saveStream, 0, SEEK_CUR);
-				if(fprintf(saveStream, "(%d, %d), %lf, %lf, %lf, %lf ",ii, iii, currentSystem->planet[i]->surface[ii][iii]->satellite,
-						currentSystem->planet[i]->surface[ii][iii]->probe, currentSystem->planet[i]->surface[ii][iii]->energy,
-						currentSystem->planet[i]->surface[ii][iii]-> mineral) < 0){
-					printf("ERROR SAVING SURFACE VALUES at system %d, planet %d, [%d, %d]\n", currentSystemIndex, i, ii, iii);
-				}
-			}
-			/* Add a line-break after every row change unless it's the final planet */
-			fseek(saveStream, 0, SEEK_CUR);
-			fprintf(saveStream, "\n");
-		}
+		/* Go past the planet's surfaces to the next planet */
+		block += sizeof(SystemPlanet) + sizeof(Surface)*planet.surfaceRows*planet.surfaceColumns;
+	}
+
+	/* Change the currentSystemIndex in the header */
+	if(header->currentSystemIndex != currentSystemIndex){
+		header->currentSystemIndex = currentSystemIndex;
 	}
 
-	/* Close the stream after saving the system's values */
-	fclose(saveStream);
+	/* Start writing the changed pages without waiting for them to finish */
+	if(msync(saveMap, saveMapSize, MS_ASYNC) != 0){
+		printf("ERROR SAVING SYSTEM %d\n", currentSystemIndex);
+	}
+}
 
+void
+loadSystem(int newSystemIndex)
+{
+	/*
+	 * Use the given index to find the given system in the save file and load it into the currentsystem value.
+	 * Save the current system before loading a new one. This will be run when changing systems or loading a savefile.
+	 * Nothing is read from the file here: the star and surfaces are used in place from the mapped savefile.
+	 * mapSavefile has already checked that the block and every count in it fit inside the savefile.
+	 */
+	int i, ii;
+	size_t size;
+	char *block, *record;
+	SaveHeader* header;
+	SaveIndex* index;
+	SystemPlanet* planet;
+	ScanGrid* grid;
+
+	if(!mapSavefile()){
+		return;
+	}
+	header = (SaveHeader*) saveMap;
+	if(newSystemIndex < 0 || newSystemIndex >= header->systemCount){
+		printf("ERROR SYSTEM %d IS NOT IN THE SAVEFILE\n", newSystemIndex);
+		return;
+	}
 
-	/* Re-open the stream to change the currentSystemIndex */
-	saveStream = fopen("savefile", "r+");
-	char firstChar = ' ';
+	/* Use the index table to go straight to the start of the system's block */
+	index = (SaveIndex*) (saveMap + sizeof(SaveHeader)) + newSystemIndex;
+	block = saveMap + index->offset;
+
+	/* Start by releasing the memory used by the previous currentSystem and make sure the arena can hold the new one,
+	 * with room for each allocation to be aligned. The star and surfaces belong to the savefile */
+	size = sizeof(CurrentSystemType) + (sizeof(SystemPlanet*) + sizeof(SystemPlanet) + sizeof(ScanGrid) + sizeof(OrbitLine))*index->system.planetCount
+			+ ARENA_ALIGNMENT*(4 + 5*index->system.planetCount);
+	record = block + sizeof(SystemStar);
+	for(i = 0; i < index->system.planetCount; i++){
+		/* Add the planet's scan grid and orbit line */
+		planet = (SystemPlanet*) record;
+		size += sizeof(double)*2*planet->surfaceRows + sizeof(ScanSection)*planet->surfaceRows*planet->surfaceColumns;
+		size += sizeof(GLfloat)*3*orbitSegments(planet);
+		record += sizeof(SystemPlanet) + sizeof(Surface)*planet->surfaceRows*planet->surfaceColumns;
+	}
+	arenaReset(&systemArena, size);
+
+	/* The index entry gives the system information and planet count. Start allocating memory for the currentSystem */
+	currentSystem = arenaAlloc(&systemArena, sizeof(CurrentSystemType));
+	strcpy(currentSystem->name, index->system.name);
+	currentSystem->x = index->system.x;
+	currentSystem->y = index->system.y;
+	currentSystem->z = index->system.z;
+	currentSystem->planetCount = index->system.planetCount;
+
+	/* 	The block starts with the currentSystem's star */
+	currentSystem->star = (SystemStar*) block;
+	block += sizeof(SystemStar);
+
+	/* Use the rest of the block and the systems planetCount to populate the planets and their surfaces */
+	currentSystem->planet = arenaAlloc(&systemArena, sizeof(SystemPlanet*)*currentSystem->planetCount);
+	currentSystem->scanGrid = arenaAlloc(&systemArena, sizeof(ScanGrid)*currentSystem->planetCount);
+	currentSystem->orbit = arenaAlloc(&systemArena, sizeof(OrbitLine)*currentSystem->planetCount);
+	for(i = 0; i < currentSystem->planetCount; i++){
+		/* Copy the planet's values, since it's surface pointer can not be kept in the savefile */
+		currentSystem->planet[i] = arenaAlloc(&systemArena, sizeof(SystemPlanet));
+		memcpy(currentSystem->planet[i], block, sizeof(SystemPlanet));
+		block += sizeof(SystemPlanet);
+
+		/* The planet's surfaces follow it's record in the same row by row order */
+		currentSystem->planet[i]->surface = (Surface*) block;
+		block += sizeof(Surface)*currentSystem->planet[i]->surfaceRows*currentSystem->planet[i]->surfaceColumns;
+
+		/* Build the planet's scanning grid */
+		grid = &currentSystem->scanGrid[i];
+		grid->rows = currentSystem->planet[i]->surfaceRows;
+		grid->columns = currentSystem->planet[i]->surfaceColumns;
+		grid->rowTop = arenaAlloc(&systemArena, sizeof(double)*grid->rows);
+		grid->rowBottom = arenaAlloc(&systemArena, sizeof(double)*grid->rows);
+		grid->section = arenaAlloc(&systemArena, sizeof(ScanSection)*grid->rows*grid->columns);
+		buildScanGrid(currentSystem->planet[i], grid);
+
+		/* Build the planet's orbit line */
+		currentSystem->orbit[i].segments = orbitSegments(currentSystem->planet[i]);
+		currentSystem->orbit[i].vertex = arenaAlloc(&systemArena, sizeof(GLfloat)*3*currentSystem->orbit[i].segments);
+		buildOrbitLine(currentSystem->planet[i], &currentSystem->orbit[i]);
+	}
 
-	/* Go past the final system line */
-	while(pos < SYSTEM_COUNT - 1){
-		/* Scan the current line assuming it is a system line and fetch the index */
-		fscanf(saveStream, "[%d]", &pos);
-		if(pos < SYSTEM_COUNT - 1){
-			/* Push the stream pointer to the next line */
-			fscanf(saveStream, "%*[^\n]%*c");
+	/* The launchList pointed into the previous system. Fill it with the satellites of the new system that were saved on their way to orbit */
+	launchCount = 0;
+	for(i = 0; i < currentSystem->planetCount; i++){
+		for(ii = 0; ii < currentSystem->planet[i]->surfaceRows*currentSystem->planet[i]->surfaceColumns; ii++){
+			if(currentSystem->planet[i]->surface[ii].satellite > 0 && currentSystem->planet[i]->surface[ii].satellite < 1){
+				addLaunch(&currentSystem->planet[i]->surface[ii].satellite);
+			}
+			if(currentSystem->planet[i]->surface[ii].probe > 0 && currentSystem->planet[i]->surface[ii].probe < 1){
+				addLaunch(&currentSystem->planet[i]->surface[ii].probe);
+			}
 		}
 	}
 
-	/* Go to the final system line holding the currentSystemIndex value, identified by the "[" */
-	while(firstChar != '['){
-		/* Scan the current line assuming it is a system line and fetch the index */
-		fscanf(saveStream, "%c", &firstChar);
+	/* Set the currentSystemIndex to the system that is currently being loaded */
+	currentSystemIndex = newSystemIndex;
+}
+
+int
+mapSavefile()
+{
+	/*
+	 * Map the whole savefile into memory if it is not already mapped. Returns 0 if the savefile
+	 * can not be mapped, was not written with the current SAVEFILE_VERSION or is damaged
+	 */
+	int fd;
+	struct stat fileStats;
+	SaveHeader* header;
+
+	if(saveMap != NULL){
+		return 1;
+	}
+
+	fd = open(SAVEFILE_NAME, O_RDWR);
+	if(fd < 0){
+		printf("ERROR OPENING SAVEFILE\n");
+		return 0;
+	}
+	fstat(fd, &fileStats);
+	saveMapSize = fileStats.st_size;
+	saveMap = mmap(NULL, saveMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	/* The mapping stays valid after the file is closed */
+	close(fd);
+
+	if(saveMap == MAP_FAILED){
+		saveMap = NULL;
+		printf("ERROR MAPPING SAVEFILE\n");
+		return 0;
+	}
 
-		if(firstChar != '['){
-			/* Push the stream pointer to the next line */
-			fscanf(saveStream, "%*[^\n]%*c");
-		}
+	header = (SaveHeader*) saveMap;
+	if(saveMapSize < sizeof(SaveHeader) || memcmp(header->magic, SAVEFILE_MAGIC, 4) != 0 || header->version != SAVEFILE_VERSION){
+		printf("ERROR SAVEFILE IS NOT A VERSION %d SAVEFILE\n", SAVEFILE_VERSION);
+		unmapSavefile();
+		return 0;
 	}
-	fseek(saveStream, -1, SEEK_CUR);
-	if(fprintf(saveStream, "[%d]\n", currentSystemIndex) < 0){
-		printf("ERROR SAVING CURRENT INDEX\n");
+	if(!validSavefile()){
+		printf("ERROR SAVEFILE IS DAMAGED\n");
+		unmapSavefile();
+		return 0;
 	}
 
-	/* Close the stream after saving the currentSystemIndex */
-	fclose(saveStream);
+	return 1;
 }
 
-void
-loadSystem(int newSystemIndex)
+int
+validSavefile()
 {
 	/*
-	 * Use the given index to find the given system in the save file and load it into the currentsystem value.
-	 * Save the current system before loading a new one. This will be run when changing systems or loading a savefile.
+	 * Check that the mapped savefile's index table and every system's block fit inside the file before anything is used
+	 * in place. Each block is walked through the star, planets and surfaces using the counts stored in the savefile,
+	 * which are also checked against the limits a savefile can have
 	 */
-	int i, ii, iii, pos;
-	double saveOffset;
-	double lastLineLength;
-	FILE* loadStream = fopen("savefile", "r");
-
-	/* Cycle through the savefile looking for the starting position for the given system index */
-	fseek(loadStream, 0, SEEK_SET);
-	pos = -1;
-	saveOffset = 0;
-
-	while(pos != newSystemIndex){
-		/* Scan the current line assuming it is a system line and fetch the index */
-		lastLineLength = ftell(loadStream);
-		fscanf(loadStream, "[%d]", &pos);
-		saveOffset =  ftell(loadStream) - lastLineLength;
-		if(pos != newSystemIndex){
-			/* Push the stream pointer to the next line */
-			fscanf(loadStream, "%*[^\n]%*c");
-		}
+	int i, ii;
+	size_t offset, tableEnd;
+	SaveHeader* header;
+	SaveIndex* index;
+	SystemPlanet* planet;
+
+	header = (SaveHeader*) saveMap;
+	tableEnd = sizeof(SaveHeader) + sizeof(SaveIndex)*SYSTEM_COUNT;
+	if(header->systemCount != SYSTEM_COUNT || header->currentSystemIndex < 0 || header->currentSystemIndex >= SYSTEM_COUNT
+			|| saveMapSize < tableEnd){
+		return 0;
 	}
 
-	/* Using the offset value and the length of the previous line, redirect the stream to it's proper position at the start of the system line */
-	fseek(loadStream, -saveOffset, SEEK_CUR);
-
-	/* Start by reallocating the memory used by the currentSystem */
-	if(currentSystem != NULL){
-		/* Free the memory used for the currentSystem if it has been initilized */
-		if(currentSystem->star != NULL){
-			free(currentSystem->star);
+	index = (SaveIndex*) (saveMap + sizeof(SaveHeader));
+	for(i = 0; i < SYSTEM_COUNT; i++){
+		/* The block has to start after the index table on an 8 byte boundary and hold the star */
+		if(index[i].offset < (long) tableEnd || index[i].offset % 8 != 0 || index[i].system.planetCount < 0
+				|| index[i].system.planetCount > SAVEFILE_MAX_PLANETS){
+			return 0;
+		}
+		offset = index[i].offset + sizeof(SystemStar);
+		if(offset > saveMapSize){
+			return 0;
 		}
 
-		if(currentSystem->planet != NULL){
-			for(i = 0; i < currentSystem->planetCount; i++){
-				if(currentSystem->planet[i] != NULL){
-					if(currentSystem->planet[i]->surface != NULL){
-						for(ii = 0; ii < currentSystem->planet[i]->surfaceRows; ii++){
-							for(iii = 0; iii < currentSystem->planet[i]->surfaceColumns; iii++){
-								if(currentSystem->planet[i]->surface[ii][iii] != NULL){
-									free(currentSystem->planet[i]->surface[ii][iii]);
-								}
-							}
-						}
-						free(currentSystem->planet[i]->surface);
-					}
-					free(currentSystem->planet[i]);
-				}
+		for(ii = 0; ii < index[i].system.planetCount; ii++){
+			/* Each planet record is followed by it's rows*columns surfaces */
+			if(offset + sizeof(SystemPlanet) > saveMapSize){
+				return 0;
+			}
+			planet = (SystemPlanet*) (saveMap + offset);
+			if(planet->surfaceRows < 0 || planet->surfaceRows > SAVEFILE_MAX_ROWS
+					|| planet->surfaceColumns < 0 || planet->surfaceColumns > SAVEFILE_MAX_COLUMNS){
+				return 0;
+			}
+			offset += sizeof(SystemPlanet) + sizeof(Surface)*planet->surfaceRows*planet->surfaceColumns;
+			if(offset > saveMapSize){
+				return 0;
 			}
 		}
-		free(currentSystem);
 	}
 
-	/* Get the first line, which gives the system information and star/planet count. Start allocating memory for the currentSystem */
-	currentSystem = malloc(sizeof(CurrentSystemType));
-	fscanf(loadStream, "[%d] %[a-zA-Z -], %lf, %lf, %lf, %d\n", &pos, currentSystem->name, &currentSystem->x,
-			&currentSystem->y, &currentSystem->z, &currentSystem->planetCount);
+	return 1;
+}
 
-	/* 	Use the following line to initialize the currentSystem's star */
-	currentSystem->star = malloc(sizeof(SystemStar));
-	fscanf(loadStream, "%[a-zA-Z -], %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf\n", currentSystem->star->name, &currentSystem->star->radius,
-			&currentSystem->star->orbitRadius, &currentSystem->star->axialTilt, &currentSystem->star->orbitTilt, &currentSystem->star->orbitOffset,
-			&currentSystem->star->dayOffset, &currentSystem->star->yearOffset, &currentSystem->star->daySpeed, &currentSystem->star->yearSpeed);
+void
+unmapSavefile()
+{
+	/*
+	 * Write back the changed pages and release the mapped savefile. This must be run before the savefile
+	 * is rewritten, and nothing can point into the savefile afterwards
+	 */
+	if(saveMap != NULL){
+		msync(saveMap, saveMapSize, MS_SYNC);
+		munmap(saveMap, saveMapSize);
+		saveMap = NULL;
+		saveMapSize = 0;
+	}
+}
 
-	/* Use the following lines and the systems planetCount to populate the planets and their surfaces */
-	currentSystem->planet = malloc(sizeof(SystemPlanet*)*currentSystem->planetCount);
-	for(i = 0; i < currentSystem->planetCount; i++){
-		/* Initialize and populate the planet's values */
-		currentSystem->planet[i] = malloc(sizeof(SystemPlanet));
-		fscanf(loadStream, "{%d, %d}, %[a-zA-Z -], %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf, %lf\n",&currentSystem->planet[i]->surfaceRows, &currentSystem->planet[i]->surfaceColumns,
-				currentSystem->planet[i]->name, &currentSystem->planet[i]->radius, &currentSystem->planet[i]->type, &currentSystem->planet[i]->orbitRadius,
-				&currentSystem->planet[i]->axialTilt, &currentSystem->planet[i]->orbitTilt, &currentSystem->planet[i]->orbitOffset, &currentSystem->planet[i]->dayOffset,
-				&currentSystem->planet[i]->yearOffset, &currentSystem->planet[i]->daySpeed, &currentSystem->planet[i]->yearSpeed);
-
-		/* Initilize the planet's surface array */
-		currentSystem->planet[i]->surface = malloc(sizeof(Surface**)*currentSystem->planet[i]->surfaceRows);
-		for(ii = 0; ii < currentSystem->planet[i]->surfaceRows; ii++){
-			currentSystem->planet[i]->surface[ii] = malloc(sizeof(Surface*)*currentSystem->planet[i]->surfaceColumns);
-			for(iii = 0; iii < currentSystem->planet[i]->surfaceColumns; iii++){
-				/* Initialize and populate the give surface object */
-				currentSystem->planet[i]->surface[ii][iii] = malloc(sizeof(Surface));
-				fscanf(loadStream, "(%*d, %*d), %lf, %lf, %lf, %lf ", &currentSystem->planet[i]->surface[ii][iii]->satellite,
-						&currentSystem->planet[i]->surface[ii][iii]->probe, &currentSystem->planet[i]->surface[ii][iii]->energy,
-						&currentSystem->planet[i]->surface[ii][iii]->mineral);
-			}
-			/* Add a line-break for every new row */
-			fscanf(loadStream, "\n");
-		}
+void
+writeSaveIndex(FILE* stream, int systemIndex, SaveIndex* index)
+{
+	/*
+	 * Write the given system's entry into the savefile's index table. The stream is left at the end
+	 * of the file so the next system's block can be appended
+	 */
+	fseek(stream, sizeof(SaveHeader) + sizeof(SaveIndex)*systemIndex, SEEK_SET);
+	if(fwrite(index, sizeof(SaveIndex), 1, stream) != 1){
+		printf("ERROR SAVING INDEX OF SYSTEM %d\n", systemIndex);
 	}
+	fseek(stream, 0, SEEK_END);
+}
 
-	/* Set the currentSystemIndex to the system that is currently being loaded */
-	currentSystemIndex = newSystemIndex;
 
-	/* Now currentSystem has loaded the proper system information from the savefile and we can close the reader */
-	fclose(loadStream);
+/* -- Memory functions ------------------------------------------------------------------------------ */
+
+void
+arenaReset(Arena* arena, size_t size)
+{
+	/*
+	 * Release everything allocated from the arena and make sure it can hold atleast the given amount of bytes.
+	 * The arena's memory is only replaced when it needs to grow, so most resets cost nothing
+	 */
+	if(arena->size < size){
+		free(arena->memory);
+		arena->memory = malloc(size);
+		arena->size = size;
+	}
+	arena->used = 0;
 }
 
+void*
+arenaAlloc(Arena* arena, size_t size)
+{
+	/*
+	 * Hand out the next size bytes of the arena. The memory stays valid until the next arenaReset
+	 */
+	void* block;
+
+	/* Keep every allocation aligned for doubles and pointers */
+	size = (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+	if(arena->used + size > arena->size){
+		printf("ERROR ARENA IS OUT OF MEMORY (%lu of %lu bytes used)\n", (unsigned long) arena->used, (unsigned long) arena->size);
+		return NULL;
+	}
+
+	block = arena->memory + arena->used;
+	arena->used += size;
+	return block;
+}
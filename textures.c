@@ -7,11 +7,68 @@
 /* These values are used to identify what object to load */
 #define TEXTURED_STATIC_BACKGROUND 1
 
+/* How many ring textures are kept uploaded at once. A system never has more than 9 planets, so this holds every ringed
+ * planet in view along with the ones from recently visited systems */
+#define RING_TEXTURE_CACHE_SIZE 32
+
+/* How many ring meshes are kept built at once. Meshes depend on the planet's radius, so they are kept for as many rings as textures */
+#define RING_MESH_CACHE_SIZE 32
+
+/* How many static noise textures are generated when the window is resized. The static background cycles through them */
+#define STATIC_TEXTURE_POOL_SIZE 8
+
+/* The width or height of the static textures for a window of the given width or height. Never below 1 for tiny windows */
+#define staticTextureSize(windowSize) ((windowSize)/5 > 1 ? (windowSize)/5 : 1)
+
+
+/* --- Type Definitions -------------------------------------------------------- */
+
+/* A ring texture that has already been uploaded. The key is the 4 digits of the planet type that the texture is made from */
+typedef struct RingTexture{
+	int key;
+	GLuint textureID;
+	unsigned int lastUse;
+} RingTexture;
+
+/* The vertices of a ring, built for an inner/outer radius and a section count. The first half of the vertices form a quad strip
+ * for the bottom side of the ring and the second half forms the top side, which winds in the opposite direction */
+typedef struct RingMesh{
+	double innerRadius, outerRadius;
+	int sections;
+	double* vertices;
+	double* textureCoords;
+	unsigned int lastUse;
+} RingMesh;
+
+
+/* --- Local Variables ------------------------------------------------------------------------------ */
+
+/* Ring textures that have been uploaded. When full, the least recently used texture is replaced */
+static RingTexture ringTextureCache[RING_TEXTURE_CACHE_SIZE];
+static int ringTextureCount;
+static unsigned int ringTextureClock;
+
+/* Ring meshes that have been built. When full, the least recently used mesh is rebuilt for the new ring */
+static RingMesh ringMeshCache[RING_MESH_CACHE_SIZE];
+static int ringMeshCount;
+static unsigned int ringMeshClock;
+
+/* Pregenerated static noise textures, sized by the window's dimensions. The size is 0 before they are first generated.
+ * staticTexturePoolCreated is set once the pool's texture names exist, which are reused every time the pool is regenerated */
+static GLuint staticTexturePool[STATIC_TEXTURE_POOL_SIZE];
+static int staticTexturePoolCreated;
+static int staticTextureWidth, staticTextureHeight;
+static int staticTextureFrame;
+
 
 /* --- Function prototypes --------------------------------------------------- */
 
 static void drawTexturedStaticBackground(double x, double y);
+static void resizeStaticTextures(int width, int height);
 static void drawTexturedRings(double radius, double sections, double type);
+static GLuint getRingTexture(int key);
+static RingMesh* getRingMesh(double innerRadius, double outerRadius, int sections);
+static void freeTextures();
 
 
 /* --- Drawing functions -------------------------------------------------------------------------- */
@@ -22,12 +79,12 @@ drawTexturedStaticBackground(double x, double y){
 	 * Draw the static background with a random texture of static. The given parameters are the object's extremities.
 	 */
 	int i, vertexCount, width, height;
-	GLuint textureID;
+	double offset;
 
 	/* Set useful values before starting the rendering, such as how many vertices and pixels will be renderedto allow a decent looking static effect */
 	vertexCount = 4;
-	width = (int) w/5;
-	height = (int) h/5;
+	width = staticTextureSize((int) w);
+	height = staticTextureSize((int) h);
 
 	/* Set the vertices for the background plane and the indices to link the vertices to the DrawElements drawing process */
 	double vertices[vertexCount*3];
@@ -63,26 +120,21 @@ drawTexturedStaticBackground(double x, double y){
 	textureCoords[6] = 5;
 	textureCoords[7] = 5;
 
-	/* Set the texture value for the background's random static. The size of the texture increases with the size of the window */
-	float rand;
-	float textureStatic[width*height*3];
-	for(i = 0; i < width*height; i++){
-		rand = (float) myRandom(0.33, 0.66);
-		textureStatic[i*3 + 0] = rand;
-		textureStatic[i*3 + 1] = rand;
-		textureStatic[i*3 + 2] = rand;
+	/* Scroll the static by a random amount to hide the pool's repetition */
+	offset = effectRandom(0, 1);
+	for(i = 0; i < vertexCount; i++){
+		textureCoords[i*2 + 0] += offset;
+		textureCoords[i*2 + 1] += offset;
 	}
 
-	/* Bind the texture and set it's parameters */
-	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	/* Generate the static textures if the window's size has not been given yet, then cycle to the next texture in the pool */
+	if(staticTextureWidth != width || staticTextureHeight != height){
+		resizeStaticTextures(w, h);
+	}
+	staticTextureFrame = (staticTextureFrame + 1)%STATIC_TEXTURE_POOL_SIZE;
+	glBindTexture(GL_TEXTURE_2D, staticTexturePool[staticTextureFrame]);
 
 	/* Link the texture, coords and the vertices together */
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_FLOAT, textureStatic);
 	glTexCoordPointer(2, GL_DOUBLE, 0, textureCoords);
 	glVertexPointer(3, GL_DOUBLE, 0, vertices);
 	/* Draw the final linked object */
@@ -95,55 +147,212 @@ drawTexturedStaticBackground(double x, double y){
 	glDisable(GL_TEXTURE_2D);
 }
 
+void
+resizeStaticTextures(int windowWidth, int windowHeight){
+	/*
+	 * Generate the pool of static noise textures for the given window size. The size of the textures increases with the size of the window
+	 */
+	int i, ii, width, height;
+	float* textureStatic;
+	double* values;
+
+	width = staticTextureSize(windowWidth);
+	height = staticTextureSize(windowHeight);
+
+	/* Create the pool's textures the first time it is generated */
+	if(!staticTexturePoolCreated){
+		glGenTextures(STATIC_TEXTURE_POOL_SIZE, staticTexturePool);
+		staticTexturePoolCreated = 1;
+	}
+	staticTextureWidth = width;
+	staticTextureHeight = height;
+
+	textureStatic = malloc(sizeof(float)*width*height*3);
+	values = malloc(sizeof(double)*width*height);
+	for(i = 0; i < STATIC_TEXTURE_POOL_SIZE; i++){
+		/* Set the texture value for a random static */
+		fillRandom(&randomStreams[STREAM_EFFECTS], values, width*height, 0.33, 0.66);
+		for(ii = 0; ii < width*height; ii++){
+			textureStatic[ii*3 + 0] = (float) values[ii];
+			textureStatic[ii*3 + 1] = (float) values[ii];
+			textureStatic[ii*3 + 2] = (float) values[ii];
+		}
+
+		/* Bind the texture, set it's parameters and upload it */
+		glBindTexture(GL_TEXTURE_2D, staticTexturePool[i]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_FLOAT, textureStatic);
+	}
+	free(textureStatic);
+	free(values);
+}
+
 void
 drawTexturedRings(double radius, double sections, double type){
 	/*
-	 * Draw textured rings of a planet by using the given parameters to determine the size/radius of the ring. Use the type value in the looks
+	 * Draw textured rings of a planet by using the given parameters to determine the size/radius of the ring. Use the type value in the looks.
+	 * The ring's mesh and texture are both cached, so each side of the ring is drawn in a single call
 	 */
-	double vertices[4*3];
-	double textureCoords[4*2];
+	RingMesh* mesh;
 	double minR, maxR;
-	GLuint indice[4];
-	GLuint textureID;
-	int i, ringSize;
-	int sepperatorDigit, sizeDigit, Func1ModDigit, Func2ModDigit;
+	int key;
 
 	/* Recover the last 4 decimal values of the planet type to use to determine the ring's textures */
-	type = 10000*((type*100) - (int) (type*100));
-	//Get the first (left-most) digit and use it as a section sepperator that stretches the rings.
-	sepperatorDigit = (int)(type/1000)%10;
-	//Get the second digit and use it to determine the overall length of the rings. Prevent it from being 0.
-	sizeDigit = 1 + (int)(type/100)%10;
-	//Get the third and fourth digits, using them as modifiers for the functions used to determine the ring's alpha channel. Prevent these from being 0
-	Func1ModDigit = 1 + (int)(type/10)%10;
-	Func2ModDigit = 1 + (int)(type)%10;
+	key = (int) (10000*((type*100) - (int) (type*100)));
 
-	/* Save the minimum and maximum distance that the ring's disk */
+	/* Save the minimum and maximum distance that the ring's disk. The second digit determines the overall length of the rings */
 	minR = 1.5;
-	maxR = minR + 0.1*sizeDigit;
+	maxR = minR + 0.1*(1 + (key/100)%10);
 
-	/* Calculate the width of the rings for the texture count */
-	ringSize = maxR*100;
+	/* Get the ring's mesh and use the cached texture for this type of ring */
+	mesh = getRingMesh(radius*minR, radius*maxR, (int) sections);
+	glBindTexture(GL_TEXTURE_2D, getRingTexture(key));
 
-	/* Set the indices used to link the drawing process to the vertices */
-	indice[0] = 0;
-	indice[1] = 1;
-	indice[2] = 2;
-	indice[3] = 3;
+	/* Link the texture coords and the vertices together */
+	glTexCoordPointer(2, GL_DOUBLE, 0, mesh->textureCoords);
+	glVertexPointer(3, GL_DOUBLE, 0, mesh->vertices);
 
-	/* Set the texture coordinates for the rings. These are the same for both sides */
-	//Top-left
-	textureCoords[0] = 0;
-	textureCoords[1] = 1;
-	//Bottom-left
-	textureCoords[2] = 0;
-	textureCoords[3] = 0;
-	//Bottom-right
-	textureCoords[4] = 1;
-	textureCoords[5] = 0;
-	//Top-right
-	textureCoords[6] = 1;
-	textureCoords[7] = 1;
+	glEnable(GL_TEXTURE_2D);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	/* Draw the bottom-side and then the top-side of the rings */
+	glDrawArrays(GL_QUAD_STRIP, 0, 2*(mesh->sections + 1));
+	glDrawArrays(GL_QUAD_STRIP, 2*(mesh->sections + 1), 2*(mesh->sections + 1));
+
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisable(GL_TEXTURE_2D);
+}
+
+RingMesh*
+getRingMesh(double innerRadius, double outerRadius, int sections){
+	/*
+	 * Return the mesh for a ring of the given size. The mesh is only built the first time a ring of this size is drawn
+	 */
+	int i, slot, inner, outer;
+	double angle;
+	RingMesh* mesh;
+
+	ringMeshClock++;
+
+	/* Use the cached mesh if there is one */
+	for(i = 0; i < ringMeshCount; i++){
+		mesh = &ringMeshCache[i];
+		if(mesh->innerRadius == innerRadius && mesh->outerRadius == outerRadius && mesh->sections == sections){
+			mesh->lastUse = ringMeshClock;
+			return mesh;
+		}
+	}
+
+	/* Find a slot for the new mesh, replacing the least recently used mesh if the cache is full */
+	if(ringMeshCount < RING_MESH_CACHE_SIZE){
+		slot = ringMeshCount++;
+	}else{
+		slot = 0;
+		for(i = 1; i < RING_MESH_CACHE_SIZE; i++){
+			if(ringMeshCache[i].lastUse < ringMeshCache[slot].lastUse){
+				slot = i;
+			}
+		}
+	}
+	mesh = &ringMeshCache[slot];
+
+	/* Each side holds an inner and outer vertex for every section's edge, so the mesh holds 4*(sections + 1) vertices */
+	if(mesh->sections != sections || mesh->vertices == NULL){
+		mesh->vertices = realloc(mesh->vertices, sizeof(double)*3*4*(sections + 1));
+		mesh->textureCoords = realloc(mesh->textureCoords, sizeof(double)*2*4*(sections + 1));
+	}
+	mesh->innerRadius = innerRadius;
+	mesh->outerRadius = outerRadius;
+	mesh->sections = sections;
+	mesh->lastUse = ringMeshClock;
+
+	/* Set the vertices of both sides. The bottom-side strip goes from the outer to the inner edge and the top-side strip goes from the inner
+	 * to the outer edge so that it's faces point the other way. The texture runs from the inner edge to the outer edge along s and is 1 texel tall */
+	for(i = 0; i <= sections; i++){
+		angle = ((double) i/sections)*2*M_PI;
+
+		//Bottom-side
+		outer = 2*i;
+		inner = 2*i + 1;
+		mesh->vertices[outer*3 + 0] = outerRadius*sin(angle);
+		mesh->vertices[outer*3 + 1] = outerRadius*cos(angle);
+		mesh->vertices[outer*3 + 2] = 0;
+		mesh->vertices[inner*3 + 0] = innerRadius*sin(angle);
+		mesh->vertices[inner*3 + 1] = innerRadius*cos(angle);
+		mesh->vertices[inner*3 + 2] = 0;
+		mesh->textureCoords[outer*2 + 0] = 1;
+		mesh->textureCoords[outer*2 + 1] = 0;
+		mesh->textureCoords[inner*2 + 0] = 0;
+		mesh->textureCoords[inner*2 + 1] = 0;
+
+		//Top-side
+		inner = 2*(sections + 1) + 2*i;
+		outer = 2*(sections + 1) + 2*i + 1;
+		mesh->vertices[outer*3 + 0] = outerRadius*sin(angle);
+		mesh->vertices[outer*3 + 1] = outerRadius*cos(angle);
+		mesh->vertices[outer*3 + 2] = 0;
+		mesh->vertices[inner*3 + 0] = innerRadius*sin(angle);
+		mesh->vertices[inner*3 + 1] = innerRadius*cos(angle);
+		mesh->vertices[inner*3 + 2] = 0;
+		mesh->textureCoords[outer*2 + 0] = 1;
+		mesh->textureCoords[outer*2 + 1] = 0;
+		mesh->textureCoords[inner*2 + 0] = 0;
+		mesh->textureCoords[inner*2 + 1] = 0;
+	}
+
+	return mesh;
+}
+
+GLuint
+getRingTexture(int key){
+	/*
+	 * Return the texture for rings made from the given key, which are the last 4 decimal values of a planet's type.
+	 * The texture is only generated and uploaded the first time the key is seen, and then reused from the cache
+	 */
+	int i, ringSize, slot;
+	int sepperatorDigit, sizeDigit, Func1ModDigit, Func2ModDigit;
+	double mult, function1, function2, function3;
+
+	ringTextureClock++;
+
+	/* Use the cached texture if there is one */
+	for(i = 0; i < ringTextureCount; i++){
+		if(ringTextureCache[i].key == key){
+			ringTextureCache[i].lastUse = ringTextureClock;
+			return ringTextureCache[i].textureID;
+		}
+	}
+
+	/* Find a slot for the new texture, replacing the least recently used texture if the cache is full */
+	if(ringTextureCount < RING_TEXTURE_CACHE_SIZE){
+		slot = ringTextureCount++;
+		glGenTextures(1, &ringTextureCache[slot].textureID);
+	}else{
+		slot = 0;
+		for(i = 1; i < RING_TEXTURE_CACHE_SIZE; i++){
+			if(ringTextureCache[i].lastUse < ringTextureCache[slot].lastUse){
+				slot = i;
+			}
+		}
+	}
+	ringTextureCache[slot].key = key;
+	ringTextureCache[slot].lastUse = ringTextureClock;
+
+	//Get the first (left-most) digit and use it as a section sepperator that stretches the rings.
+	sepperatorDigit = (key/1000)%10;
+	//Get the second digit and use it to determine the overall length of the rings. Prevent it from being 0.
+	sizeDigit = 1 + (key/100)%10;
+	//Get the third and fourth digits, using them as modifiers for the functions used to determine the ring's alpha channel. Prevent these from being 0
+	Func1ModDigit = 1 + (key/10)%10;
+	Func2ModDigit = 1 + key%10;
+
+	/* Calculate the width of the rings for the texture count */
+	ringSize = (1.5 + 0.1*sizeDigit)*100;
 
 	/* Set the texture for the rings */
 	float textureRings[ringSize*4];
@@ -154,9 +363,7 @@ drawTexturedRings(double radius, double sections, double type){
 	}
 
 	/* Set the alpha channel for the rings. This uses the type's previously saved digits and a set of trig functions */
-
-	double mult = 0.5 + sepperatorDigit/10.0;
-	double function1, function2, function3;
+	mult = 0.5 + sepperatorDigit/10.0;
 	for(i = 0; i < ringSize; i++){
 		function1 = (1 + sin((i/100.0f)*2*M_PI*mult*1))/2.0;
 		function2 = (1 + cos((i/100.0f)*2*M_PI*mult*(0.7 + Func1ModDigit/5.0)))/2.0;
@@ -178,70 +385,30 @@ drawTexturedRings(double radius, double sections, double type){
 		}
 	}
 
-	/* Bind the texture and set it's parameters */
-	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	/* Bind the texture, set it's parameters and upload it */
+	glBindTexture(GL_TEXTURE_2D, ringTextureCache[slot].textureID);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-
-	/* Link the texture, coords and the vertices together */
-	glTexCoordPointer(2, GL_DOUBLE, 0, textureCoords);
-	glVertexPointer(3, GL_DOUBLE, 0, vertices);
-
-	/* To draw the rings, set the vertices to the current face to draw, then run the glDrawelements command using
-	 * all the previously set values for the textures and texCoords. Do this for every face on the given side of the ring */
-	glEnable(GL_TEXTURE_2D);
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-
-	/* Set the vertices and draw the bottom-side of the rings */
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ringSize, 1, 0, GL_RGBA, GL_FLOAT, textureRings);
-	for(i = 1; i <= sections; i++){
-		vertices[0] = radius*minR*sin(((i-1)/sections)*2*M_PI);
-		vertices[1] = radius*minR*cos(((i-1)/sections)*2*M_PI);
-		vertices[2] = 0;
 
-		vertices[3] = radius*minR*sin((i/sections)*2*M_PI);
-		vertices[4] = radius*minR*cos((i/sections)*2*M_PI);
-		vertices[5] = 0;
-
-		vertices[6] = radius*maxR*sin((i/sections)*2*M_PI);
-		vertices[7] = radius*maxR*cos((i/sections)*2*M_PI);
-		vertices[8] = 0;
-
-		vertices[9] = radius*maxR*sin(((i-1)/sections)*2*M_PI);
-		vertices[10] = radius*maxR*cos(((i-1)/sections)*2*M_PI);
-		vertices[11] = 0;
-
-		/* Draw the bottom face of the rings */
-		glDrawElements(GL_QUADS, 4, GL_UNSIGNED_INT, indice);
-	}
-
-	/* Set the vertices and draw the top-side of the rings */
-	for(i = 1; i <= sections; i++){
-		vertices[0] = radius*maxR*sin((i/sections)*2*M_PI);
-		vertices[1] = radius*maxR*cos((i/sections)*2*M_PI);
-		vertices[2] = 0;
+	return ringTextureCache[slot].textureID;
+}
 
-		vertices[3] = radius*minR*sin((i/sections)*2*M_PI);
-		vertices[4] = radius*minR*cos((i/sections)*2*M_PI);
-		vertices[5] = 0;
 
-		vertices[6] = radius*minR*sin(((i-1)/sections)*2*M_PI);
-		vertices[7] = radius*minR*cos(((i-1)/sections)*2*M_PI);
-		vertices[8] = 0;
+/* --- Memory functions -------------------------------------------------------------------------- */
 
-		vertices[9] = radius*maxR*sin(((i-1)/sections)*2*M_PI);
-		vertices[10] = radius*maxR*cos(((i-1)/sections)*2*M_PI);
-		vertices[11] = 0;
+void
+freeTextures(){
+	/*
+	 * Release the cached ring meshes
+	 */
+	int i;
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, ringSize, 0, GL_RGBA, GL_FLOAT, textureRings);
-		glDrawElements(GL_QUADS, 4, GL_UNSIGNED_INT, indice);
+	for(i = 0; i < ringMeshCount; i++){
+		free(ringMeshCache[i].vertices);
+		free(ringMeshCache[i].textureCoords);
 	}
-
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisable(GL_TEXTURE_2D);
+	ringMeshCount = 0;
 }